@@ -21,6 +21,7 @@
 #include "FATFileSystem.h"
 #include "LittleFileSystem.h"
 #include "simple-mbed-cloud-client.h"
+#include "pal_configuration.h"
 #include "greentea-client/test_env.h"
 #include "common_defines_test.h"
 
@@ -39,6 +40,28 @@ void led_thread() {
 
 RawSerial pc(USBTX, USBRX);
 
+// Registration times are only compared between warm boots, the first boot includes the bootstrap.
+// With session resume, the session is cleared before the first reset so that boot does a full
+// handshake, and one more reset times the resumption of the session it stored.
+#if defined(PAL_USE_SSL_SESSION_RESUME) && PAL_USE_SSL_SESSION_RESUME && defined(MCC_SSL_SESSION_ITEM_NAME)
+#define TEST_LAST_ITERATION 2
+#else
+#define TEST_LAST_ITERATION 1
+#endif
+
+static const char *handshake_type(int iteration) {
+#if defined(PAL_USE_SSL_SESSION_RESUME) && PAL_USE_SSL_SESSION_RESUME
+#if defined(MCC_SSL_SESSION_ITEM_NAME)
+    return iteration == 1 ? "full" : "resumed";
+#else
+    // The session cannot be cleared without its item name, so every warm boot resumes it
+    return "resumed";
+#endif
+#else
+    return "full";
+#endif
+}
+
 void wait_nb(uint16_t ms) {
     wait_ms(ms);
 }
@@ -74,6 +97,22 @@ void registered(const ConnectorClientEndpointInfo *endpoint) {
     endpointInfo = endpoint;
 }
 
+void reset_for_next_iteration() {
+    char _key[20] = { };
+    char _value[128] = { };
+
+    logger("[INFO] Resetting device.\r\n");
+    greentea_send_kv("test_advance", 0);
+    while (1) {
+        greentea_parse_kv(_key, _value, sizeof(_key), sizeof(_value));
+
+        if (strcmp(_key, "reset") == 0) {
+            system_reset();
+            break;
+        }
+    }
+}
+
 void post_test_callback(MbedCloudClientResource *resource, const uint8_t *buffer, uint16_t size) {
     logger("[INFO] POST test callback executed.\r\n");
     greentea_send_kv("verify_lwm2m_post_test_result", 0);
@@ -222,17 +261,18 @@ void spdmc_testsuite_connect(void) {
     client.on_registered(&registered);
     client.register_and_connect();
 
-    i = 1200; // wait 120 seconds
-    while (i-- > 0 && !client.is_client_registered()) {
-        wait_ms(100);
-    }
-
-    // Get registration status.
-    bool client_registered = client.is_client_registered();
+    // Get registration status, sleeping until registered for up to 120 seconds.
+    bool client_registered = client.wait_for_registration(120000);
     if (client_registered) {
         client_status = 0;
         wait_nb(100);
         logger("[INFO] Device successfully registered to Pelion DM.\r\n");
+
+        if (iteration > 0) {
+            mcc_startup_timing timing = client.get_startup_timing();
+            pc.printf("[BENCH] Registration (%s handshake): %lu ms\r\n", handshake_type(iteration),
+                      (unsigned long)timing.registration_ms);
+        }
     } else {
         client_status = -1;
         logger("[ERROR] Device failed to register.\r\n");
@@ -241,7 +281,7 @@ void spdmc_testsuite_connect(void) {
     if (iteration == 0) {
         test_case_finish("Pelion Bootstrap & Reg.", (client_status == 0), (client_status != 0));
     } else {
-        test_case_finish("Pelion Re-register", (client_status == 0), (client_status != 0));
+        test_case_finish("Pelion Re-register", iteration - 1 + (client_status == 0), (client_status != 0));
     }
 
     if (iteration == 0) {
@@ -277,17 +317,15 @@ void spdmc_testsuite_connect(void) {
         test_case_finish("Pelion Directory", (reg_status == 0), (reg_status != 0));
 
         if (reg_status == 0) {
-            logger("[INFO] Resetting device.\r\n");
-            greentea_send_kv("test_advance", 0);
-            while (1) {
-                greentea_parse_kv(_key, _value, sizeof(_key), sizeof(_value));
-
-                if (strcmp(_key, "reset") == 0) {
-                    system_reset();
-                    break;
-                }
-            }
+#if TEST_LAST_ITERATION > 1
+            // The first warm boot does a full handshake
+            StorageHelper(&sd, &fs).clear_ssl_session();
+#endif
+            reset_for_next_iteration();
         }
+    } else if (iteration < TEST_LAST_ITERATION && client_status == 0) {
+        // The next warm boot resumes the session stored by this one
+        reset_for_next_iteration();
     } else {
         //Start consistent identity test.
         test_case_start("Post-reset Identity", 8);
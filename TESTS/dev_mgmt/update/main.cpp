@@ -267,13 +267,8 @@ void spdmc_testsuite_update(void) {
     client.on_registered(&registered);
     client.register_and_connect();
 
-    i = 1200; // wait 120 seconds
-    while (i-- > 0 && !client.is_client_registered()) {
-        wait_ms(100);
-    }
-
-    // Get registration status.
-    bool client_registered = client.is_client_registered();
+    // Get registration status, sleeping until registered for up to 120 seconds.
+    bool client_registered = client.wait_for_registration(120000);
     if (client_registered) {
         client_status = 0;
         wait_nb(100);
@@ -0,0 +1,197 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+
+// Micro benchmarks of the library code paths that run per notification or per lookup.
+// Run natively, under 'perf record' or under 'valgrind --tool=callgrind'.
+//
+// Usage: bench [iterations]
+
+#include <chrono>
+#include "mbed.h"
+#include "FileSystem.h"
+#include "dns-cache.h"
+#include "notification-coalescer.h"
+#include "notification-queue.h"
+#include "notification-scheduler.h"
+#include "resource-stream.h"
+#include "senml-writer.h"
+
+static volatile uint32_t bench_sink;
+
+class Timer {
+public:
+    Timer() : _start(std::chrono::steady_clock::now()) {}
+
+    void report(const char *name, unsigned long iterations) {
+        std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - _start;
+        printf("[BENCH] %-28s %10.1f ns/op\n", name, (double)elapsed.count() / iterations);
+    }
+
+private:
+    std::chrono::steady_clock::time_point _start;
+};
+
+static void bench_scheduler(unsigned long iterations) {
+    NotificationScheduler s;
+    s.configure(4, 64);
+    NotificationScheduler::Entry e[64];
+    for (int i = 0; i < 64; i++) {
+        e[i].priority = i % MCC_PRIORITY_COUNT;
+    }
+
+    Timer t;
+    for (unsigned long i = 0; i < iterations; i++) {
+        s.enqueue(&e[i % 64], i);
+        NotificationScheduler::Entry *next = s.next(i);
+        if (next) {
+            s.complete(next, true, i);
+        }
+    }
+    t.report("scheduler enqueue+send", iterations);
+    bench_sink = s.pending();
+}
+
+static void bench_coalescer(unsigned long iterations) {
+    NotificationCoalescer c;
+    c.configure(1000, 60000, 0.5f);
+    uint32_t published = 0;
+
+    Timer t;
+    for (unsigned long i = 0; i < iterations; i++) {
+        float value = (float)(i % 100) / 10.0f;
+        if (c.on_write(value, true, i)) {
+            c.on_published(value, i);
+            published++;
+        }
+    }
+    t.report("coalescer write", iterations);
+    bench_sink = published;
+}
+
+static void bench_senml(SenmlWriter::Format format, const char *name, unsigned long iterations) {
+    uint8_t buffer[1024];
+    size_t length = 0;
+    const unsigned records = 32;
+
+    Timer t;
+    for (unsigned long i = 0; i < iterations; i++) {
+        SenmlWriter w(format, buffer, sizeof(buffer));
+        w.begin(records);
+        for (unsigned r = 0; r < records; r++) {
+            w.add(r == 0 ? "/3303/0/5700" : NULL, r == 0 ? 1500000000 : 0, r * 10.0f, 20.0f + r / 8.0f);
+        }
+        length = w.end();
+    }
+    t.report(name, iterations * records);
+    bench_sink = length;
+}
+
+static void bench_notification_queue(unsigned long iterations) {
+    FileSystem fs("fs");
+    NotificationQueue q("queue");
+    q.open(&fs, 128, MCC_QUEUE_DROP_OLDEST);
+    uint64_t written = fs.bytes_written();
+
+    mcc_queued_record r;
+    memset(&r, 0, sizeof(r));
+    r.length = 4;
+
+    Timer t;
+    for (unsigned long i = 0; i < iterations; i++) {
+        r.timestamp = i;
+        q.push(&r);
+        if (i % 2) {
+            q.pop();
+        }
+    }
+    t.report("queue push (+pop every 2nd)", iterations);
+
+    // What the flash sees, the ring buffer rewrites one slot and the header
+    printf("[BENCH] %-28s %10.1f bytes/record\n", "queue flash writes",
+           (double)(fs.bytes_written() - written) / iterations);
+    bench_sink = q.count();
+}
+
+static void bench_file_sink(unsigned long iterations) {
+    FileSystem fs("fs");
+    ResourceFileSink sink("payload");
+    uint8_t block[1024];
+    memset(block, 0x5a, sizeof(block));
+
+    Timer t;
+    sink.begin(&fs);
+    for (unsigned long i = 0; i < iterations; i++) {
+        if (sink.size() >= 256 * 1024) {
+            sink.finish();
+            sink.begin(&fs);
+        }
+        sink.write(block, sizeof(block));
+    }
+    sink.finish();
+    t.report("file sink write+crc 1KiB", iterations);
+    bench_sink = sink.checksum();
+}
+
+class ResolvingNetwork : public NetworkInterface {
+public:
+    virtual nsapi_error_t connect() { return NSAPI_ERROR_OK; }
+    virtual nsapi_error_t disconnect() { return NSAPI_ERROR_OK; }
+    virtual nsapi_error_t gethostbyname(const char *host, SocketAddress *address, nsapi_version_t version) {
+        return address->set_ip_address("192.0.2.1") ? NSAPI_ERROR_OK : NSAPI_ERROR_DNS_FAILURE;
+    }
+
+protected:
+    virtual NetworkStack *get_stack() { return NULL; }
+};
+
+static void bench_dns_hit(unsigned long iterations) {
+    FileSystem fs("fs");
+    ResolvingNetwork net;
+    DnsCacheInterface dns("dns");
+    dns.set_interface(&net);
+    dns.open(&fs, 86400);
+
+    const char *hosts[] = { "bootstrap.example.com", "lwm2m.example.com" };
+    SocketAddress address;
+    dns.gethostbyname(hosts[0], &address);
+    dns.gethostbyname(hosts[1], &address);
+
+    Timer t;
+    for (unsigned long i = 0; i < iterations; i++) {
+        dns.gethostbyname(hosts[i % 2], &address);
+    }
+    t.report("dns cache hit", iterations);
+    bench_sink = dns.stats().hits;
+}
+
+int main(int argc, char **argv) {
+    unsigned long iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    if (iterations == 0) {
+        iterations = 1;
+    }
+
+    bench_scheduler(iterations);
+    bench_coalescer(iterations);
+    bench_senml(SenmlWriter::CBOR, "senml cbor record", iterations / 32 + 1);
+    bench_senml(SenmlWriter::JSON, "senml json record", iterations / 32 + 1);
+    bench_notification_queue(iterations);
+    bench_file_sink(iterations / 16 + 1);
+    bench_dns_hit(iterations);
+    return 0;
+}
@@ -0,0 +1,91 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+
+#ifndef MBED_SIM_BLOCK_DEVICE_H
+#define MBED_SIM_BLOCK_DEVICE_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace mbed {
+
+typedef uint64_t bd_addr_t;
+typedef uint64_t bd_size_t;
+
+enum {
+    BD_ERROR_OK                 = 0,
+    BD_ERROR_DEVICE_ERROR       = -4001,
+};
+
+/**
+ * Host version of mbed::BlockDevice, only the calls the library uses
+ */
+class BlockDevice {
+public:
+    virtual ~BlockDevice() {}
+
+    virtual int init() = 0;
+    virtual int deinit() = 0;
+    virtual int read(void *buffer, bd_addr_t addr, bd_size_t size) = 0;
+    virtual int program(const void *buffer, bd_addr_t addr, bd_size_t size) = 0;
+    virtual int erase(bd_addr_t addr, bd_size_t size) = 0;
+    virtual bd_size_t get_read_size() const = 0;
+    virtual bd_size_t get_program_size() const = 0;
+    virtual bd_size_t get_erase_size() const = 0;
+    virtual bd_size_t size() const = 0;
+};
+
+/**
+ * Block device in RAM, erased to 0xff
+ */
+class HeapBlockDevice : public BlockDevice {
+public:
+    /**
+     * @param size Size of the device in bytes
+     * @param block Size of a read, program and erase block
+     */
+    HeapBlockDevice(bd_size_t size, bd_size_t block = 512);
+
+    virtual int init();
+    virtual int deinit();
+    virtual int read(void *buffer, bd_addr_t addr, bd_size_t size);
+    virtual int program(const void *buffer, bd_addr_t addr, bd_size_t size);
+    virtual int erase(bd_addr_t addr, bd_size_t size);
+    virtual bd_size_t get_read_size() const;
+    virtual bd_size_t get_program_size() const;
+    virtual bd_size_t get_erase_size() const;
+    virtual bd_size_t size() const;
+
+    /**
+     * Number of bytes programmed since construction
+     */
+    bd_size_t programmed() const;
+
+private:
+    bool valid(bd_addr_t addr, bd_size_t size) const;
+
+    bd_size_t _block;
+    std::vector<uint8_t> _data;
+    bool _init;
+    bd_size_t _programmed;
+};
+
+} // namespace mbed
+
+#endif // MBED_SIM_BLOCK_DEVICE_H
@@ -0,0 +1,82 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef MBED_SIM_CALLBACK_H
+#define MBED_SIM_CALLBACK_H
+
+#include <cstddef>
+#include <functional>
+
+namespace mbed {
+
+template <typename F>
+class Callback;
+
+/**
+ * Host version of mbed::Callback, backed by std::function.
+ * Only the constructors the library uses are provided.
+ */
+template <typename R, typename... Args>
+class Callback<R(Args...)> {
+public:
+    Callback() {}
+    Callback(std::nullptr_t) {}
+    Callback(R (*func)(Args...)) {
+        if (func) _func = func;
+    }
+    template <typename T, typename U>
+    Callback(U *obj, R (T::*method)(Args...)) {
+        _func = [obj, method](Args... args) -> R { return (obj->*method)(args...); };
+    }
+    template <typename T, typename U>
+    Callback(const U *obj, R (T::*method)(Args...) const) {
+        _func = [obj, method](Args... args) -> R { return (obj->*method)(args...); };
+    }
+
+    R call(Args... args) const {
+        return _func(args...);
+    }
+    R operator()(Args... args) const {
+        return _func(args...);
+    }
+    explicit operator bool() const {
+        return static_cast<bool>(_func);
+    }
+
+private:
+    std::function<R(Args...)> _func;
+};
+
+template <typename R, typename... Args>
+Callback<R(Args...)> callback(R (*func)(Args...)) {
+    return Callback<R(Args...)>(func);
+}
+
+template <typename T, typename U, typename R, typename... Args>
+Callback<R(Args...)> callback(U *obj, R (T::*method)(Args...)) {
+    return Callback<R(Args...)>(obj, method);
+}
+
+template <typename T, typename U, typename R, typename... Args>
+Callback<R(Args...)> callback(const U *obj, R (T::*method)(Args...) const) {
+    return Callback<R(Args...)>(obj, method);
+}
+
+} // namespace mbed
+
+#endif // MBED_SIM_CALLBACK_H
@@ -0,0 +1,131 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+
+#ifndef MBED_SIM_EVENT_QUEUE_H
+#define MBED_SIM_EVENT_QUEUE_H
+
+#include <stdint.h>
+#include <list>
+#include <mutex>
+#include "Callback.h"
+
+namespace events {
+
+/**
+ * Host version of events::EventQueue, running on the virtual clock of mbed_sim.h.
+ *
+ * Events are only run from dispatch(), in order of their due time, on the
+ * calling thread. Posting and cancelling are thread safe.
+ */
+class EventQueue {
+public:
+    EventQueue();
+    ~EventQueue();
+
+    /**
+     * Run a callback on the next dispatch
+     *
+     * @returns Unique id of the event, 0 if the callback is empty
+     */
+    template <typename F>
+    int call(F f) {
+        return post(0, -1, mbed::Callback<void()>(f));
+    }
+
+    template <typename T, typename R>
+    int call(T *obj, R (T::*method)()) {
+        return post(0, -1, mbed::callback(obj, method));
+    }
+
+    /**
+     * Run a callback after a delay
+     */
+    template <typename F>
+    int call_in(int ms, F f) {
+        return post(ms, -1, mbed::Callback<void()>(f));
+    }
+
+    template <typename T, typename R>
+    int call_in(int ms, T *obj, R (T::*method)()) {
+        return post(ms, -1, mbed::callback(obj, method));
+    }
+
+    /**
+     * Run a callback periodically, the first time after one period
+     */
+    template <typename F>
+    int call_every(int ms, F f) {
+        return post(ms, ms, mbed::Callback<void()>(f));
+    }
+
+    template <typename T, typename R>
+    int call_every(int ms, T *obj, R (T::*method)()) {
+        return post(ms, ms, mbed::callback(obj, method));
+    }
+
+    /**
+     * Cancel an event that did not run yet, or a periodic event
+     *
+     * @returns true if the event was cancelled
+     */
+    bool cancel(int id);
+
+    /**
+     * Run events for a period of simulated time. The virtual clock is moved to
+     * the due time of each event before it runs, and to the end of the period after.
+     *
+     * @param ms Period to run, 0 to only run the events that are due now
+     */
+    void dispatch(int ms = 0);
+
+    /**
+     * Number of events waiting, including periodic ones
+     */
+    unsigned pending();
+
+    /**
+     * Drop all events
+     */
+    void clear();
+
+private:
+    struct event {
+        int id;
+        uint64_t due_ms;
+        int period_ms;
+        mbed::Callback<void()> cb;
+    };
+
+    int post(int delay_ms, int period_ms, mbed::Callback<void()> cb);
+    bool take_due(uint64_t until_ms, event *e);
+
+    std::list<event> _events;
+    int _next_id;
+    std::recursive_mutex _mutex;
+};
+
+} // namespace events
+
+/**
+ * The shared event queue. It is not dispatched by a thread of its own,
+ * tests call dispatch() on it.
+ */
+events::EventQueue *mbed_event_queue();
+
+#endif // MBED_SIM_EVENT_QUEUE_H
@@ -0,0 +1,125 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+
+#ifndef MBED_SIM_FILE_SYSTEM_H
+#define MBED_SIM_FILE_SYSTEM_H
+
+#include <stdint.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "BlockDevice.h"
+
+namespace mbed {
+
+class File;
+
+/**
+ * Host version of mbed::FileSystem. Files are kept in memory, for as long as the
+ * object lives, so a reboot is simulated by opening them again on the same object.
+ *
+ * A write budget simulates a full device: writes beyond it fail with -ENOSPC.
+ */
+class FileSystem {
+public:
+    FileSystem(const char *name = NULL);
+    virtual ~FileSystem();
+
+    /**
+     * Attach a block device. The block device is not used to store the files.
+     */
+    virtual int mount(BlockDevice *bd);
+    virtual int unmount();
+
+    /**
+     * Remove all files
+     */
+    virtual int reformat(BlockDevice *bd = NULL);
+
+    virtual int remove(const char *path);
+    virtual int rename(const char *path, const char *newpath);
+
+    /**
+     * Limit the number of bytes that can still be written, -1 for no limit
+     */
+    void set_write_budget(long bytes);
+
+    /**
+     * Number of bytes written to files since construction
+     */
+    uint64_t bytes_written() const;
+
+    /**
+     * Number of sync and close calls since construction
+     */
+    uint32_t syncs() const;
+
+private:
+    friend class File;
+
+    std::map<std::string, std::vector<uint8_t> > _files;
+    BlockDevice *_bd;
+    long _write_budget;
+    uint64_t _bytes_written;
+    uint32_t _syncs;
+};
+
+/**
+ * Host version of mbed::File
+ */
+class File {
+public:
+    File();
+    ~File();
+
+    /**
+     * @param flags O_RDONLY, O_WRONLY or O_RDWR, with O_CREAT, O_EXCL, O_TRUNC and O_APPEND
+     *
+     * @returns 0 if successful, negative error code if not
+     */
+    int open(FileSystem *fs, const char *path, int flags = O_RDONLY);
+    int close();
+    ssize_t read(void *buffer, size_t size);
+    ssize_t write(const void *buffer, size_t size);
+    off_t seek(off_t offset, int whence = SEEK_SET);
+    off_t tell();
+    void rewind();
+    off_t size();
+    int sync();
+
+private:
+    File(const File &);
+    File &operator=(const File &);
+
+    std::vector<uint8_t> *data();
+
+    FileSystem *_fs;
+    std::string _path;
+    int _flags;
+    off_t _pos;
+};
+
+} // namespace mbed
+
+using namespace mbed;
+
+#endif // MBED_SIM_FILE_SYSTEM_H
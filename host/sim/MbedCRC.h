@@ -0,0 +1,80 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+
+#ifndef MBED_SIM_MBED_CRC_H
+#define MBED_SIM_MBED_CRC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace mbed {
+
+typedef enum crc_polynomial {
+    POLY_OTHER          = 0,
+    POLY_8BIT_CCITT     = 0x07,
+    POLY_7BIT_SD        = 0x9,
+    POLY_16BIT_CCITT    = 0x1021,
+    POLY_16BIT_IBM      = 0x8005,
+    POLY_32BIT_ANSI     = 0x04C11DB7,
+} crc_polynomial_t;
+
+typedef size_t crc_data_size_t;
+
+/**
+ * Host version of mbed::MbedCRC. Only CRC-32 (ANSI) is provided, computed
+ * bitwise with the same reflection and final XOR as the Mbed OS table version.
+ */
+template <uint32_t polynomial = POLY_32BIT_ANSI, uint8_t width = 32>
+class MbedCRC {
+    static_assert(polynomial == POLY_32BIT_ANSI && width == 32, "only CRC-32 (ANSI) is simulated");
+
+public:
+    int32_t compute_partial_start(uint32_t *crc) {
+        *crc = 0xFFFFFFFF;
+        return 0;
+    }
+
+    int32_t compute_partial(const void *buffer, crc_data_size_t size, uint32_t *crc) {
+        const uint8_t *data = static_cast<const uint8_t *>(buffer);
+        uint32_t value = *crc;
+        for (crc_data_size_t i = 0; i < size; i++) {
+            value ^= data[i];
+            for (int bit = 0; bit < 8; bit++) {
+                value = (value >> 1) ^ (0xEDB88320 & (0 - (value & 1)));
+            }
+        }
+        *crc = value;
+        return 0;
+    }
+
+    int32_t compute_partial_stop(uint32_t *crc) {
+        *crc ^= 0xFFFFFFFF;
+        return 0;
+    }
+
+    int32_t compute(const void *buffer, crc_data_size_t size, uint32_t *crc) {
+        compute_partial_start(crc);
+        compute_partial(buffer, size, crc);
+        return compute_partial_stop(crc);
+    }
+};
+
+} // namespace mbed
+
+#endif // MBED_SIM_MBED_CRC_H
@@ -0,0 +1,144 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+
+#ifndef MBED_SIM_NETWORK_INTERFACE_H
+#define MBED_SIM_NETWORK_INTERFACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "Callback.h"
+
+typedef int nsapi_error_t;
+typedef signed int nsapi_value_or_error_t;
+
+enum nsapi_error {
+    NSAPI_ERROR_OK                  =  0,
+    NSAPI_ERROR_WOULD_BLOCK         = -3001,
+    NSAPI_ERROR_UNSUPPORTED         = -3002,
+    NSAPI_ERROR_PARAMETER           = -3003,
+    NSAPI_ERROR_NO_CONNECTION       = -3004,
+    NSAPI_ERROR_NO_SOCKET           = -3005,
+    NSAPI_ERROR_NO_ADDRESS          = -3006,
+    NSAPI_ERROR_NO_MEMORY           = -3007,
+    NSAPI_ERROR_NO_SSID             = -3008,
+    NSAPI_ERROR_DNS_FAILURE         = -3009,
+    NSAPI_ERROR_DHCP_FAILURE        = -3010,
+    NSAPI_ERROR_AUTH_FAILURE        = -3011,
+    NSAPI_ERROR_DEVICE_ERROR        = -3012,
+    NSAPI_ERROR_IN_PROGRESS         = -3013,
+    NSAPI_ERROR_ALREADY             = -3014,
+    NSAPI_ERROR_IS_CONNECTED        = -3015,
+    NSAPI_ERROR_CONNECTION_LOST     = -3016,
+    NSAPI_ERROR_CONNECTION_TIMEOUT  = -3017,
+    NSAPI_ERROR_ADDRESS_IN_USE      = -3018,
+    NSAPI_ERROR_TIMEOUT             = -3019,
+    NSAPI_ERROR_BUSY                = -3020,
+};
+
+typedef enum nsapi_connection_status {
+    NSAPI_STATUS_LOCAL_UP           = 0,
+    NSAPI_STATUS_GLOBAL_UP          = 1,
+    NSAPI_STATUS_DISCONNECTED       = 2,
+    NSAPI_STATUS_CONNECTING         = 3,
+    NSAPI_STATUS_ERROR_UNSUPPORTED  = NSAPI_ERROR_UNSUPPORTED
+} nsapi_connection_status_t;
+
+typedef enum nsapi_event {
+    NSAPI_EVENT_CONNECTION_STATUS_CHANGE = 0,
+} nsapi_event_t;
+
+typedef enum nsapi_version {
+    NSAPI_UNSPEC,
+    NSAPI_IPv4,
+    NSAPI_IPv6,
+} nsapi_version_t;
+
+typedef struct nsapi_addr {
+    nsapi_version_t version;
+    uint8_t bytes[16];
+} nsapi_addr_t;
+
+/**
+ * Host version of SocketAddress, parses and formats IPv4 and IPv6 literals
+ */
+class SocketAddress {
+public:
+    SocketAddress(const char *addr = NULL, uint16_t port = 0);
+    SocketAddress(nsapi_addr_t addr, uint16_t port = 0);
+
+    /**
+     * @returns true if the string is an IP address literal
+     */
+    bool set_ip_address(const char *addr);
+    void set_addr(nsapi_addr_t addr);
+    void set_port(uint16_t port);
+
+    const char *get_ip_address() const;
+    nsapi_addr_t get_addr() const;
+    nsapi_version_t get_ip_version() const;
+    uint16_t get_port() const;
+
+    operator bool() const;
+
+private:
+    nsapi_addr_t _addr;
+    uint16_t _port;
+    mutable char _text[48];
+};
+
+class NetworkStack;
+class NetworkInterface;
+
+/**
+ * Stack of an interface. The host has no network stack, so this is whatever
+ * the interface returns from get_stack().
+ */
+NetworkStack *nsapi_create_stack(NetworkInterface *iface);
+
+typedef mbed::Callback<void(nsapi_error_t result, SocketAddress *address)> hostbyname_cb_t;
+
+/**
+ * Host version of NetworkInterface. There is no network stack behind it, every
+ * call reports NSAPI_ERROR_UNSUPPORTED unless a test double overrides it.
+ */
+class NetworkInterface {
+public:
+    virtual ~NetworkInterface() {}
+
+    virtual nsapi_error_t connect() = 0;
+    virtual nsapi_error_t disconnect() = 0;
+    virtual const char *get_ip_address();
+    virtual const char *get_mac_address();
+    virtual const char *get_netmask();
+    virtual const char *get_gateway();
+    virtual nsapi_error_t gethostbyname(const char *host, SocketAddress *address, nsapi_version_t version = NSAPI_UNSPEC);
+    virtual nsapi_value_or_error_t gethostbyname_async(const char *host, hostbyname_cb_t callback,
+                                                       nsapi_version_t version = NSAPI_UNSPEC);
+    virtual nsapi_error_t gethostbyname_async_cancel(int id);
+    virtual void attach(mbed::Callback<void(nsapi_event_t, intptr_t)> status_cb);
+    virtual nsapi_connection_status_t get_connection_status() const;
+    virtual nsapi_error_t set_blocking(bool blocking);
+
+protected:
+    friend NetworkStack *nsapi_create_stack(NetworkInterface *iface);
+
+    virtual NetworkStack *get_stack() = 0;
+};
+
+#endif // MBED_SIM_NETWORK_INTERFACE_H
@@ -0,0 +1,40 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+
+#ifndef MBED_SIM_MBED_H
+#define MBED_SIM_MBED_H
+
+// Host replacement of mbed.h: the C library, plus the parts of Mbed OS the library uses
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Callback.h"
+#include "EventQueue.h"
+#include "MbedCRC.h"
+#include "rtos.h"
+#include "mbed_sim.h"
+
+using namespace mbed;
+using namespace events;
+
+#endif // MBED_SIM_MBED_H
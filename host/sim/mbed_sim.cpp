@@ -0,0 +1,512 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+
+#include "mbed.h"
+#include "mbed_trace.h"
+#include "FileSystem.h"
+#include "NetworkInterface.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <atomic>
+
+static std::atomic<uint64_t> sim_time_ms(0);
+
+uint64_t mbed_sim_time_ms() {
+    return sim_time_ms.load();
+}
+
+void mbed_sim_advance_ms(uint64_t ms) {
+    sim_time_ms += ms;
+}
+
+void mbed_sim_reset() {
+    mbed_event_queue()->clear();
+    sim_time_ms = 0;
+}
+
+uint64_t rtos::Kernel::get_ms_count() {
+    return mbed_sim_time_ms();
+}
+
+// Event queue
+
+namespace events {
+
+EventQueue::EventQueue()
+    : _next_id(1)
+{
+}
+
+EventQueue::~EventQueue() {
+}
+
+int EventQueue::post(int delay_ms, int period_ms, mbed::Callback<void()> cb) {
+    if (!cb) return 0;
+
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    event e;
+    e.id = _next_id++;
+    e.due_ms = mbed_sim_time_ms() + (delay_ms > 0 ? delay_ms : 0);
+    e.period_ms = period_ms;
+    e.cb = cb;
+
+    // Keep the list sorted by due time, events due at the same time run in order of posting
+    std::list<event>::iterator it = _events.begin();
+    while (it != _events.end() && it->due_ms <= e.due_ms) {
+        ++it;
+    }
+    _events.insert(it, e);
+    return e.id;
+}
+
+bool EventQueue::cancel(int id) {
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    for (std::list<event>::iterator it = _events.begin(); it != _events.end(); ++it) {
+        if (it->id == id) {
+            _events.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EventQueue::take_due(uint64_t until_ms, event *e) {
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    if (_events.empty() || _events.front().due_ms > until_ms) {
+        return false;
+    }
+    *e = _events.front();
+    _events.pop_front();
+    return true;
+}
+
+void EventQueue::dispatch(int ms) {
+    uint64_t until = mbed_sim_time_ms() + (ms > 0 ? ms : 0);
+
+    event e;
+    while (take_due(until, &e)) {
+        uint64_t now = mbed_sim_time_ms();
+        if (e.due_ms > now) {
+            mbed_sim_advance_ms(e.due_ms - now);
+        }
+
+        if (e.period_ms > 0) {
+            // Queue the next run first, so the callback can cancel it
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            event next = e;
+            next.due_ms = e.due_ms + e.period_ms;
+            std::list<event>::iterator it = _events.begin();
+            while (it != _events.end() && it->due_ms <= next.due_ms) {
+                ++it;
+            }
+            _events.insert(it, next);
+        }
+
+        e.cb();
+    }
+
+    uint64_t now = mbed_sim_time_ms();
+    if (until > now) {
+        mbed_sim_advance_ms(until - now);
+    }
+}
+
+unsigned EventQueue::pending() {
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    return _events.size();
+}
+
+void EventQueue::clear() {
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    _events.clear();
+}
+
+} // namespace events
+
+events::EventQueue *mbed_event_queue() {
+    static events::EventQueue queue;
+    return &queue;
+}
+
+// Block device
+
+namespace mbed {
+
+HeapBlockDevice::HeapBlockDevice(bd_size_t size, bd_size_t block)
+    : _block(block), _data(size, 0xff), _init(false), _programmed(0)
+{
+}
+
+int HeapBlockDevice::init() {
+    _init = true;
+    return BD_ERROR_OK;
+}
+
+int HeapBlockDevice::deinit() {
+    _init = false;
+    return BD_ERROR_OK;
+}
+
+bool HeapBlockDevice::valid(bd_addr_t addr, bd_size_t size) const {
+    return _init && addr % _block == 0 && size % _block == 0 && addr + size <= _data.size();
+}
+
+int HeapBlockDevice::read(void *buffer, bd_addr_t addr, bd_size_t size) {
+    if (!valid(addr, size)) return BD_ERROR_DEVICE_ERROR;
+    memcpy(buffer, &_data[addr], size);
+    return BD_ERROR_OK;
+}
+
+int HeapBlockDevice::program(const void *buffer, bd_addr_t addr, bd_size_t size) {
+    if (!valid(addr, size)) return BD_ERROR_DEVICE_ERROR;
+    memcpy(&_data[addr], buffer, size);
+    _programmed += size;
+    return BD_ERROR_OK;
+}
+
+int HeapBlockDevice::erase(bd_addr_t addr, bd_size_t size) {
+    if (!valid(addr, size)) return BD_ERROR_DEVICE_ERROR;
+    memset(&_data[addr], 0xff, size);
+    return BD_ERROR_OK;
+}
+
+bd_size_t HeapBlockDevice::get_read_size() const {
+    return _block;
+}
+
+bd_size_t HeapBlockDevice::get_program_size() const {
+    return _block;
+}
+
+bd_size_t HeapBlockDevice::get_erase_size() const {
+    return _block;
+}
+
+bd_size_t HeapBlockDevice::size() const {
+    return _data.size();
+}
+
+bd_size_t HeapBlockDevice::programmed() const {
+    return _programmed;
+}
+
+// File system
+
+FileSystem::FileSystem(const char *name)
+    : _bd(NULL), _write_budget(-1), _bytes_written(0), _syncs(0)
+{
+    (void)name;
+}
+
+FileSystem::~FileSystem() {
+}
+
+int FileSystem::mount(BlockDevice *bd) {
+    if (!bd) return -EINVAL;
+    _bd = bd;
+    return _bd->init();
+}
+
+int FileSystem::unmount() {
+    if (!_bd) return -EINVAL;
+    int status = _bd->deinit();
+    _bd = NULL;
+    return status;
+}
+
+int FileSystem::reformat(BlockDevice *bd) {
+    (void)bd;
+    _files.clear();
+    return 0;
+}
+
+int FileSystem::remove(const char *path) {
+    return _files.erase(path) ? 0 : -ENOENT;
+}
+
+int FileSystem::rename(const char *path, const char *newpath) {
+    std::map<std::string, std::vector<uint8_t> >::iterator it = _files.find(path);
+    if (it == _files.end()) return -ENOENT;
+
+    std::vector<uint8_t> data;
+    data.swap(it->second);
+    _files.erase(it);
+    _files[newpath].swap(data);
+    return 0;
+}
+
+void FileSystem::set_write_budget(long bytes) {
+    _write_budget = bytes;
+}
+
+uint64_t FileSystem::bytes_written() const {
+    return _bytes_written;
+}
+
+uint32_t FileSystem::syncs() const {
+    return _syncs;
+}
+
+File::File()
+    : _fs(NULL), _flags(0), _pos(0)
+{
+}
+
+File::~File() {
+    close();
+}
+
+int File::open(FileSystem *fs, const char *path, int flags) {
+    if (_fs) return -EINVAL;
+    if (!fs || !path) return -EINVAL;
+
+    std::map<std::string, std::vector<uint8_t> >::iterator it = fs->_files.find(path);
+    if (it == fs->_files.end()) {
+        if (!(flags & O_CREAT)) return -ENOENT;
+        fs->_files[path];
+    } else {
+        if ((flags & O_CREAT) && (flags & O_EXCL)) return -EEXIST;
+        if ((flags & O_TRUNC) && (flags & O_ACCMODE) != O_RDONLY) {
+            it->second.clear();
+        }
+    }
+
+    _fs = fs;
+    _path = path;
+    _flags = flags;
+    _pos = 0;
+    return 0;
+}
+
+int File::close() {
+    if (!_fs) return 0;
+    _fs->_syncs++;
+    _fs = NULL;
+    return 0;
+}
+
+std::vector<uint8_t> *File::data() {
+    if (!_fs) return NULL;
+    std::map<std::string, std::vector<uint8_t> >::iterator it = _fs->_files.find(_path);
+    return it == _fs->_files.end() ? NULL : &it->second;
+}
+
+ssize_t File::read(void *buffer, size_t size) {
+    std::vector<uint8_t> *file = data();
+    if (!file || (_flags & O_ACCMODE) == O_WRONLY) return -EBADF;
+
+    if ((size_t)_pos >= file->size()) return 0;
+    size_t available = file->size() - _pos;
+    if (size > available) size = available;
+    memcpy(buffer, &(*file)[_pos], size);
+    _pos += size;
+    return size;
+}
+
+ssize_t File::write(const void *buffer, size_t size) {
+    std::vector<uint8_t> *file = data();
+    if (!file || (_flags & O_ACCMODE) == O_RDONLY) return -EBADF;
+
+    if (_fs->_write_budget >= 0) {
+        if ((long)size > _fs->_write_budget) return -ENOSPC;
+        _fs->_write_budget -= size;
+    }
+
+    if (_flags & O_APPEND) {
+        _pos = file->size();
+    }
+    if ((size_t)_pos + size > file->size()) {
+        file->resize(_pos + size);
+    }
+    memcpy(&(*file)[_pos], buffer, size);
+    _pos += size;
+    _fs->_bytes_written += size;
+    return size;
+}
+
+off_t File::seek(off_t offset, int whence) {
+    std::vector<uint8_t> *file = data();
+    if (!file) return -EBADF;
+
+    off_t base = whence == SEEK_CUR ? _pos : whence == SEEK_END ? (off_t)file->size() : 0;
+    if (base + offset < 0) return -EINVAL;
+    _pos = base + offset;
+    return _pos;
+}
+
+off_t File::tell() {
+    return _fs ? _pos : -EBADF;
+}
+
+void File::rewind() {
+    _pos = 0;
+}
+
+off_t File::size() {
+    std::vector<uint8_t> *file = data();
+    return file ? (off_t)file->size() : -EBADF;
+}
+
+int File::sync() {
+    if (!_fs) return -EBADF;
+    _fs->_syncs++;
+    return 0;
+}
+
+} // namespace mbed
+
+// Network
+
+SocketAddress::SocketAddress(const char *addr, uint16_t port)
+    : _port(port)
+{
+    memset(&_addr, 0, sizeof(_addr));
+    if (addr) {
+        set_ip_address(addr);
+    }
+}
+
+SocketAddress::SocketAddress(nsapi_addr_t addr, uint16_t port)
+    : _addr(addr), _port(port)
+{
+}
+
+bool SocketAddress::set_ip_address(const char *addr) {
+    nsapi_addr_t parsed;
+    memset(&parsed, 0, sizeof(parsed));
+    if (inet_pton(AF_INET, addr, parsed.bytes) == 1) {
+        parsed.version = NSAPI_IPv4;
+    } else if (inet_pton(AF_INET6, addr, parsed.bytes) == 1) {
+        parsed.version = NSAPI_IPv6;
+    } else {
+        return false;
+    }
+    _addr = parsed;
+    return true;
+}
+
+void SocketAddress::set_addr(nsapi_addr_t addr) {
+    _addr = addr;
+}
+
+void SocketAddress::set_port(uint16_t port) {
+    _port = port;
+}
+
+const char *SocketAddress::get_ip_address() const {
+    if (_addr.version == NSAPI_UNSPEC) return NULL;
+
+    int family = _addr.version == NSAPI_IPv4 ? AF_INET : AF_INET6;
+    return inet_ntop(family, _addr.bytes, _text, sizeof(_text));
+}
+
+nsapi_addr_t SocketAddress::get_addr() const {
+    return _addr;
+}
+
+nsapi_version_t SocketAddress::get_ip_version() const {
+    return _addr.version;
+}
+
+uint16_t SocketAddress::get_port() const {
+    return _port;
+}
+
+SocketAddress::operator bool() const {
+    if (_addr.version == NSAPI_UNSPEC) return false;
+    for (int i = 0; i < 16; i++) {
+        if (_addr.bytes[i]) return true;
+    }
+    return false;
+}
+
+NetworkStack *nsapi_create_stack(NetworkInterface *iface) {
+    return iface ? iface->get_stack() : NULL;
+}
+
+const char *NetworkInterface::get_ip_address() {
+    return NULL;
+}
+
+const char *NetworkInterface::get_mac_address() {
+    return NULL;
+}
+
+const char *NetworkInterface::get_netmask() {
+    return NULL;
+}
+
+const char *NetworkInterface::get_gateway() {
+    return NULL;
+}
+
+nsapi_error_t NetworkInterface::gethostbyname(const char *host, SocketAddress *address, nsapi_version_t version) {
+    (void)version;
+    // Literals resolve without a stack, like in Mbed OS
+    return address->set_ip_address(host) ? NSAPI_ERROR_OK : NSAPI_ERROR_UNSUPPORTED;
+}
+
+nsapi_value_or_error_t NetworkInterface::gethostbyname_async(const char *host, hostbyname_cb_t callback,
+                                                             nsapi_version_t version) {
+    (void)host;
+    (void)callback;
+    (void)version;
+    return NSAPI_ERROR_UNSUPPORTED;
+}
+
+nsapi_error_t NetworkInterface::gethostbyname_async_cancel(int id) {
+    (void)id;
+    return NSAPI_ERROR_UNSUPPORTED;
+}
+
+void NetworkInterface::attach(mbed::Callback<void(nsapi_event_t, intptr_t)> status_cb) {
+    (void)status_cb;
+}
+
+nsapi_connection_status_t NetworkInterface::get_connection_status() const {
+    return NSAPI_STATUS_ERROR_UNSUPPORTED;
+}
+
+nsapi_error_t NetworkInterface::set_blocking(bool blocking) {
+    (void)blocking;
+    return NSAPI_ERROR_UNSUPPORTED;
+}
+
+// Trace
+
+int mbed_trace_init(void) {
+    return 0;
+}
+
+void mbed_tracef(int dlevel, const char *grp, const char *fmt, ...) {
+    static const bool enabled = getenv("MBED_SIM_TRACE") != NULL;
+    if (!enabled) return;
+
+    const char *level = dlevel == TRACE_LEVEL_ERROR ? "ERR " :
+                        dlevel == TRACE_LEVEL_WARN ? "WARN" :
+                        dlevel == TRACE_LEVEL_INFO ? "INFO" : "DBG ";
+    fprintf(stderr, "[%s][%-4s]: ", level, grp);
+
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+}
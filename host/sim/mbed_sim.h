@@ -0,0 +1,48 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+
+#ifndef MBED_SIM_H
+#define MBED_SIM_H
+
+#include <stdint.h>
+
+/**
+ * Controls of the simulated Mbed OS layer, used by host tests and benchmarks.
+ *
+ * Time does not pass on its own: Kernel::get_ms_count() and the event queue
+ * read a virtual clock that only moves through mbed_sim_advance_ms() and
+ * EventQueue::dispatch(), so timing dependent code runs the same on every run.
+ */
+
+/**
+ * Current value of the virtual clock
+ */
+uint64_t mbed_sim_time_ms();
+
+/**
+ * Move the virtual clock forward, without running events
+ */
+void mbed_sim_advance_ms(uint64_t ms);
+
+/**
+ * Rewind the virtual clock to 0 and drop all events of the shared event queue
+ */
+void mbed_sim_reset();
+
+#endif // MBED_SIM_H
@@ -0,0 +1,46 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+
+#ifndef MBED_SIM_MBED_TRACE_H
+#define MBED_SIM_MBED_TRACE_H
+
+#define TRACE_LEVEL_ERROR   0x02
+#define TRACE_LEVEL_WARN    0x04
+#define TRACE_LEVEL_INFO    0x08
+#define TRACE_LEVEL_DEBUG   0x10
+
+#define tr_error(...)   mbed_tracef(TRACE_LEVEL_ERROR, TRACE_GROUP, __VA_ARGS__)
+#define tr_err(...)     mbed_tracef(TRACE_LEVEL_ERROR, TRACE_GROUP, __VA_ARGS__)
+#define tr_warn(...)    mbed_tracef(TRACE_LEVEL_WARN, TRACE_GROUP, __VA_ARGS__)
+#define tr_warning(...) mbed_tracef(TRACE_LEVEL_WARN, TRACE_GROUP, __VA_ARGS__)
+#define tr_info(...)    mbed_tracef(TRACE_LEVEL_INFO, TRACE_GROUP, __VA_ARGS__)
+#define tr_debug(...)   mbed_tracef(TRACE_LEVEL_DEBUG, TRACE_GROUP, __VA_ARGS__)
+
+/**
+ * Nothing to set up on the host
+ */
+int mbed_trace_init(void);
+
+/**
+ * Print a trace line to stderr. Traces are only printed when the environment
+ * variable MBED_SIM_TRACE is set, so benchmarks do not measure the console.
+ */
+void mbed_tracef(int dlevel, const char *grp, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+#endif // MBED_SIM_MBED_TRACE_H
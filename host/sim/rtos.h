@@ -0,0 +1,60 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+
+#ifndef MBED_SIM_RTOS_H
+#define MBED_SIM_RTOS_H
+
+#include <stdint.h>
+#include <mutex>
+
+namespace rtos {
+
+/**
+ * Host version of rtos::Mutex, recursive like the RTX one
+ */
+class Mutex {
+public:
+    Mutex() {}
+    Mutex(const char *name) { (void)name; }
+
+    void lock() { _mutex.lock(); }
+    bool trylock() { return _mutex.try_lock(); }
+    void unlock() { _mutex.unlock(); }
+
+private:
+    Mutex(const Mutex &);
+    Mutex &operator=(const Mutex &);
+
+    std::recursive_mutex _mutex;
+};
+
+namespace Kernel {
+
+/**
+ * Milliseconds since boot, read from the virtual clock of mbed_sim.h
+ */
+uint64_t get_ms_count();
+
+} // namespace Kernel
+
+} // namespace rtos
+
+using namespace rtos;
+
+#endif // MBED_SIM_RTOS_H
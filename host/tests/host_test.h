@@ -0,0 +1,73 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+// Unity style assertions for the host tests, without a test framework to install
+
+#include <stdio.h>
+#include <string.h>
+
+static int host_test_failures = 0;
+static bool host_test_case_failed = false;
+
+#define TEST_FAIL_MESSAGE(message) do { \
+        printf("%s:%d: %s\n", __FILE__, __LINE__, message); \
+        host_test_case_failed = true; \
+        return; \
+    } while (0)
+
+#define TEST_ASSERT(condition) do { \
+        if (!(condition)) TEST_FAIL_MESSAGE("expected " #condition); \
+    } while (0)
+
+#define TEST_ASSERT_FALSE(condition) TEST_ASSERT(!(condition))
+
+#define TEST_ASSERT_EQUAL(expected, actual) do { \
+        long long e_ = (long long)(expected), a_ = (long long)(actual); \
+        if (e_ != a_) { \
+            printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+            host_test_case_failed = true; \
+            return; \
+        } \
+    } while (0)
+
+#define TEST_ASSERT_EQUAL_STRING(expected, actual) do { \
+        const char *e_ = (expected), *a_ = (actual); \
+        if (!a_ || strcmp(e_, a_) != 0) { \
+            printf("%s:%d: %s is \"%s\", expected \"%s\"\n", __FILE__, __LINE__, #actual, a_ ? a_ : "(null)", e_); \
+            host_test_case_failed = true; \
+            return; \
+        } \
+    } while (0)
+
+#define TEST_ASSERT_EQUAL_MEMORY(expected, actual, length) \
+    TEST_ASSERT(memcmp((expected), (actual), (length)) == 0)
+
+#define RUN_TEST(test) do { \
+        host_test_case_failed = false; \
+        test(); \
+        printf("%s %s\n", host_test_case_failed ? "FAIL" : "ok  ", #test); \
+        if (host_test_case_failed) host_test_failures++; \
+    } while (0)
+
+#define TEST_RESULT() (host_test_failures ? 1 : 0)
+
+#endif // HOST_TEST_H
@@ -0,0 +1,265 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+
+#include "host_test.h"
+#include "mbed.h"
+#include "dns-cache.h"
+
+#define RESOLVE_MS 120
+
+/**
+ * Network that resolves "hostN" to 10.0.0.N, taking RESOLVE_MS of simulated time.
+ * Background lookups complete when the test calls complete_async().
+ */
+class SimNetwork : public NetworkInterface {
+public:
+    SimNetwork() : lookups(0), async_lookups(0), fail(false), offset(0) {}
+
+    virtual nsapi_error_t connect() { return NSAPI_ERROR_OK; }
+    virtual nsapi_error_t disconnect() { return NSAPI_ERROR_OK; }
+
+    virtual nsapi_error_t gethostbyname(const char *host, SocketAddress *address, nsapi_version_t version) {
+        if (address->set_ip_address(host)) return NSAPI_ERROR_OK;
+
+        lookups++;
+        mbed_sim_advance_ms(RESOLVE_MS);
+        return resolve(host, address);
+    }
+
+    virtual nsapi_value_or_error_t gethostbyname_async(const char *host, hostbyname_cb_t callback, nsapi_version_t version) {
+        async_lookups++;
+        _async_host = host;
+        _async_cb = callback;
+        return 1;
+    }
+
+    void complete_async() {
+        SocketAddress address;
+        nsapi_error_t status = resolve(_async_host, &address);
+        _async_cb(status, &address);
+    }
+
+    int lookups;
+    int async_lookups;
+    bool fail;
+    int offset;
+
+protected:
+    virtual NetworkStack *get_stack() { return NULL; }
+
+private:
+    nsapi_error_t resolve(const char *host, SocketAddress *address) {
+        if (fail || strncmp(host, "host", 4) != 0) return NSAPI_ERROR_DNS_FAILURE;
+
+        char ip[16];
+        snprintf(ip, sizeof(ip), "10.0.0.%d", atoi(host + 4) + offset);
+        address->set_ip_address(ip);
+        return NSAPI_ERROR_OK;
+    }
+
+    const char *_async_host;
+    hostbyname_cb_t _async_cb;
+};
+
+static void test_second_lookup_is_a_hit() {
+    mbed_sim_reset();
+    FileSystem fs("fs");
+    SimNetwork net;
+    DnsCacheInterface dns("dns");
+    dns.set_interface(&net);
+    TEST_ASSERT_EQUAL(0, dns.open(&fs, 86400));
+
+    SocketAddress address;
+    TEST_ASSERT_EQUAL(NSAPI_ERROR_OK, dns.gethostbyname("host1", &address));
+    TEST_ASSERT_EQUAL_STRING("10.0.0.1", address.get_ip_address());
+    TEST_ASSERT_EQUAL(NSAPI_ERROR_OK, dns.gethostbyname("host1", &address));
+    TEST_ASSERT_EQUAL_STRING("10.0.0.1", address.get_ip_address());
+    TEST_ASSERT_EQUAL(1, net.lookups);
+    TEST_ASSERT_EQUAL(0, net.async_lookups);
+
+    mcc_dns_stats stats = dns.stats();
+    TEST_ASSERT_EQUAL(2, stats.lookups);
+    TEST_ASSERT_EQUAL(1, stats.hits);
+    TEST_ASSERT_EQUAL(RESOLVE_MS, stats.resolve_ms);
+}
+
+static void test_cache_survives_reboot() {
+    mbed_sim_reset();
+    FileSystem fs("fs");
+    SimNetwork net;
+    {
+        DnsCacheInterface dns("dns");
+        dns.set_interface(&net);
+        dns.open(&fs, 86400);
+        SocketAddress address;
+        dns.gethostbyname("host2", &address);
+    }
+
+    DnsCacheInterface dns("dns");
+    dns.set_interface(&net);
+    TEST_ASSERT_EQUAL(0, dns.open(&fs, 86400));
+    SocketAddress address;
+    TEST_ASSERT_EQUAL(NSAPI_ERROR_OK, dns.gethostbyname("host2", &address));
+    TEST_ASSERT_EQUAL_STRING("10.0.0.2", address.get_ip_address());
+    TEST_ASSERT_EQUAL(1, net.lookups);
+    TEST_ASSERT_EQUAL(0, dns.stats().resolve_ms);
+}
+
+static void test_stale_entry_is_refreshed_in_background() {
+    mbed_sim_reset();
+    FileSystem fs("fs");
+    SimNetwork net;
+    DnsCacheInterface dns("dns");
+    dns.set_interface(&net);
+    dns.open(&fs, 0);
+
+    SocketAddress address;
+    dns.gethostbyname("host3", &address);
+
+    // The server moved, the cached address is still returned at once
+    net.offset = 100;
+    TEST_ASSERT_EQUAL(NSAPI_ERROR_OK, dns.gethostbyname("host3", &address));
+    TEST_ASSERT_EQUAL_STRING("10.0.0.3", address.get_ip_address());
+    TEST_ASSERT_EQUAL(1, net.async_lookups);
+
+    net.complete_async();
+    mbed_event_queue()->dispatch();
+    TEST_ASSERT_EQUAL(1, dns.stats().refreshes);
+
+    TEST_ASSERT_EQUAL(NSAPI_ERROR_OK, dns.gethostbyname("host3", &address));
+    TEST_ASSERT_EQUAL_STRING("10.0.0.103", address.get_ip_address());
+    TEST_ASSERT_EQUAL(1, net.lookups);
+
+    // The refreshed address was written to the file
+    DnsCacheInterface rebooted("dns");
+    rebooted.set_interface(&net);
+    rebooted.open(&fs, 86400);
+    rebooted.gethostbyname("host3", &address);
+    TEST_ASSERT_EQUAL_STRING("10.0.0.103", address.get_ip_address());
+}
+
+static void test_failures_and_literals_are_not_cached() {
+    mbed_sim_reset();
+    FileSystem fs("fs");
+    SimNetwork net;
+    DnsCacheInterface dns("dns");
+    dns.set_interface(&net);
+    dns.open(&fs, 86400);
+
+    SocketAddress address;
+    net.fail = true;
+    TEST_ASSERT_EQUAL(NSAPI_ERROR_DNS_FAILURE, dns.gethostbyname("host4", &address));
+    net.fail = false;
+    TEST_ASSERT_EQUAL(NSAPI_ERROR_OK, dns.gethostbyname("host4", &address));
+    TEST_ASSERT_EQUAL(2, net.lookups);
+
+    TEST_ASSERT_EQUAL(NSAPI_ERROR_OK, dns.gethostbyname("192.0.2.1", &address));
+    TEST_ASSERT_EQUAL_STRING("192.0.2.1", address.get_ip_address());
+    TEST_ASSERT_EQUAL(2, dns.stats().lookups);
+}
+
+static void test_oldest_entry_is_evicted() {
+    mbed_sim_reset();
+    FileSystem fs("fs");
+    SimNetwork net;
+    DnsCacheInterface dns("dns");
+    dns.set_interface(&net);
+    dns.open(&fs, 86400);
+
+    SocketAddress address;
+    const char *hosts[] = { "host10", "host11", "host12", "host13", "host14" };
+    for (int i = 0; i < 5; i++) {
+        dns.gethostbyname(hosts[i], &address);
+    }
+    TEST_ASSERT_EQUAL(5, net.lookups);
+
+    dns.gethostbyname("host14", &address);
+    dns.gethostbyname("host11", &address);
+    TEST_ASSERT_EQUAL(5, net.lookups);
+    dns.gethostbyname("host10", &address);
+    TEST_ASSERT_EQUAL(6, net.lookups);
+}
+
+/**
+ * Records the answers of asynchronous lookups
+ */
+struct Resolved {
+    Resolved() : calls(0), result(NSAPI_ERROR_OK) {}
+
+    void done(nsapi_error_t status, SocketAddress *address) {
+        calls++;
+        result = status;
+        strncpy(ip, address->get_ip_address(), sizeof(ip));
+    }
+
+    int calls;
+    nsapi_error_t result;
+    char ip[48];
+};
+
+static void test_async_lookups_use_the_cache() {
+    mbed_sim_reset();
+    FileSystem fs("fs");
+    SimNetwork net;
+    DnsCacheInterface dns("dns");
+    dns.set_interface(&net);
+    dns.open(&fs, 86400);
+
+    // A miss is resolved by the network and stored
+    Resolved resolved;
+    TEST_ASSERT_EQUAL(1, dns.gethostbyname_async("host5", callback(&resolved, &Resolved::done)));
+    TEST_ASSERT_EQUAL(0, resolved.calls);
+    net.complete_async();
+    mbed_event_queue()->dispatch();
+    TEST_ASSERT_EQUAL(1, resolved.calls);
+    TEST_ASSERT_EQUAL_STRING("10.0.0.5", resolved.ip);
+
+    // A hit is answered before the call returns
+    TEST_ASSERT_EQUAL(NSAPI_ERROR_OK, dns.gethostbyname_async("host5", callback(&resolved, &Resolved::done)));
+    TEST_ASSERT_EQUAL(2, resolved.calls);
+    TEST_ASSERT_EQUAL_STRING("10.0.0.5", resolved.ip);
+    TEST_ASSERT_EQUAL(1, net.async_lookups);
+
+    mcc_dns_stats stats = dns.stats();
+    TEST_ASSERT_EQUAL(2, stats.lookups);
+    TEST_ASSERT_EQUAL(1, stats.hits);
+    TEST_ASSERT_EQUAL(0, stats.refreshes);
+
+    // A cancelled lookup is not passed on, but still fills the cache
+    int id = dns.gethostbyname_async("host6", callback(&resolved, &Resolved::done));
+    TEST_ASSERT_EQUAL(NSAPI_ERROR_OK, dns.gethostbyname_async_cancel(id));
+    net.complete_async();
+    mbed_event_queue()->dispatch();
+    TEST_ASSERT_EQUAL(2, resolved.calls);
+
+    SocketAddress address;
+    TEST_ASSERT_EQUAL(NSAPI_ERROR_OK, dns.gethostbyname("host6", &address));
+    TEST_ASSERT_EQUAL_STRING("10.0.0.6", address.get_ip_address());
+    TEST_ASSERT_EQUAL(0, net.lookups);
+}
+
+int main() {
+    RUN_TEST(test_second_lookup_is_a_hit);
+    RUN_TEST(test_cache_survives_reboot);
+    RUN_TEST(test_stale_entry_is_refreshed_in_background);
+    RUN_TEST(test_failures_and_literals_are_not_cached);
+    RUN_TEST(test_oldest_entry_is_evicted);
+    RUN_TEST(test_async_lookups_use_the_cache);
+    return TEST_RESULT();
+}
@@ -0,0 +1,237 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+
+#include "host_test.h"
+#include "mbed.h"
+#include "FileSystem.h"
+#include "notification-queue.h"
+
+static mcc_queued_record make_record(uint16_t n, uint16_t instance_id = 0) {
+    mcc_queued_record r;
+    memset(&r, 0, sizeof(r));
+    r.object_id = 3303;
+    r.instance_id = instance_id;
+    r.resource_id = 5700;
+    r.timestamp = 1000 + n;
+    r.length = 2;
+    r.value[0] = n >> 8;
+    r.value[1] = n & 0xff;
+    return r;
+}
+
+// Pops all records, and returns their numbers in order
+static int drain(NotificationQueue &q, uint32_t *numbers, int max) {
+    int count = 0;
+    mcc_queued_record r;
+    while (count < max && q.peek(&r) == 0) {
+        numbers[count++] = r.timestamp - 1000;
+        q.pop();
+    }
+    return count;
+}
+
+static void test_fifo_order() {
+    FileSystem fs("fs");
+    NotificationQueue q("queue");
+    TEST_ASSERT_EQUAL(0, q.open(&fs, 4, MCC_QUEUE_DROP_OLDEST));
+
+    mcc_queued_record r;
+    TEST_ASSERT_EQUAL(1, q.peek(&r));
+    for (uint16_t i = 0; i < 3; i++) {
+        r = make_record(i);
+        TEST_ASSERT_EQUAL(0, q.push(&r));
+    }
+    TEST_ASSERT_EQUAL(3, q.count());
+
+    uint32_t numbers[8];
+    TEST_ASSERT_EQUAL(3, drain(q, numbers, 8));
+    TEST_ASSERT_EQUAL(0, numbers[0]);
+    TEST_ASSERT_EQUAL(1, numbers[1]);
+    TEST_ASSERT_EQUAL(2, numbers[2]);
+    TEST_ASSERT_EQUAL(0, q.count());
+}
+
+static void test_survives_reboot() {
+    FileSystem fs("fs");
+    {
+        NotificationQueue q("queue");
+        q.open(&fs, 4, MCC_QUEUE_DROP_OLDEST);
+        for (uint16_t i = 0; i < 6; i++) {
+            mcc_queued_record r = make_record(i);
+            q.push(&r);
+        }
+        q.pop();
+    }
+
+    NotificationQueue q("queue");
+    TEST_ASSERT_EQUAL(0, q.open(&fs, 4, MCC_QUEUE_DROP_OLDEST));
+    TEST_ASSERT_EQUAL(3, q.count());
+    TEST_ASSERT_EQUAL(2, q.dropped());
+
+    uint32_t numbers[8];
+    TEST_ASSERT_EQUAL(3, drain(q, numbers, 8));
+    TEST_ASSERT_EQUAL(3, numbers[0]);
+    TEST_ASSERT_EQUAL(5, numbers[2]);
+
+    // Another capacity starts over
+    mcc_queued_record r = make_record(9);
+    q.push(&r);
+    q.close();
+    NotificationQueue resized("queue");
+    TEST_ASSERT_EQUAL(0, resized.open(&fs, 8, MCC_QUEUE_DROP_OLDEST));
+    TEST_ASSERT_EQUAL(0, resized.count());
+    TEST_ASSERT_EQUAL(0, resized.dropped());
+}
+
+static void test_drop_newest() {
+    FileSystem fs("fs");
+    NotificationQueue q("queue");
+    q.open(&fs, 2, MCC_QUEUE_DROP_NEWEST);
+    for (uint16_t i = 0; i < 2; i++) {
+        mcc_queued_record r = make_record(i);
+        TEST_ASSERT_EQUAL(0, q.push(&r));
+    }
+    mcc_queued_record r = make_record(2);
+    TEST_ASSERT_EQUAL(1, q.push(&r));
+    TEST_ASSERT_EQUAL(1, q.dropped());
+
+    uint32_t numbers[8];
+    TEST_ASSERT_EQUAL(2, drain(q, numbers, 8));
+    TEST_ASSERT_EQUAL(0, numbers[0]);
+    TEST_ASSERT_EQUAL(1, numbers[1]);
+}
+
+static void test_downsample_keeps_history_span() {
+    FileSystem fs("fs");
+    NotificationQueue q("queue");
+    q.open(&fs, 4, MCC_QUEUE_DOWNSAMPLE);
+    for (uint16_t i = 0; i < 5; i++) {
+        mcc_queued_record r = make_record(i);
+        TEST_ASSERT_EQUAL(0, q.push(&r));
+    }
+
+    // 0 1 2 3 is halved to 1 3, keeping the newest, then 4 is appended
+    uint32_t numbers[8];
+    TEST_ASSERT_EQUAL(3, drain(q, numbers, 8));
+    TEST_ASSERT_EQUAL(1, numbers[0]);
+    TEST_ASSERT_EQUAL(3, numbers[1]);
+    TEST_ASSERT_EQUAL(4, numbers[2]);
+    TEST_ASSERT_EQUAL(2, q.dropped());
+}
+
+static void test_downsample_per_resource() {
+    FileSystem fs("fs");
+    NotificationQueue q("queue");
+    q.open(&fs, 4, MCC_QUEUE_DOWNSAMPLE);
+
+    // Two interleaved resources, each keeps its newest record
+    for (uint16_t i = 0; i < 5; i++) {
+        mcc_queued_record r = make_record(i, i % 2);
+        TEST_ASSERT_EQUAL(0, q.push(&r));
+    }
+
+    uint32_t numbers[8];
+    TEST_ASSERT_EQUAL(3, drain(q, numbers, 8));
+    TEST_ASSERT_EQUAL(2, numbers[0]);
+    TEST_ASSERT_EQUAL(3, numbers[1]);
+    TEST_ASSERT_EQUAL(4, numbers[2]);
+    TEST_ASSERT_EQUAL(2, q.dropped());
+
+    // Only newest records left, so the oldest is dropped
+    for (uint16_t i = 0; i < 5; i++) {
+        mcc_queued_record r = make_record(10 + i, i);
+        TEST_ASSERT_EQUAL(0, q.push(&r));
+    }
+    TEST_ASSERT_EQUAL(4, q.count());
+    TEST_ASSERT_EQUAL(3, q.dropped());
+    TEST_ASSERT_EQUAL(4, drain(q, numbers, 8));
+    TEST_ASSERT_EQUAL(11, numbers[0]);
+    TEST_ASSERT_EQUAL(14, numbers[3]);
+}
+
+static void test_sync_interval() {
+    FileSystem fs("fs");
+    NotificationQueue q("queue");
+    q.open(&fs, 8, MCC_QUEUE_DROP_OLDEST, 4);
+    uint32_t syncs = fs.syncs();
+
+    for (uint16_t i = 0; i < 6; i++) {
+        mcc_queued_record r = make_record(i);
+        TEST_ASSERT_EQUAL(0, q.push(&r));
+    }
+    TEST_ASSERT_EQUAL(syncs + 1, fs.syncs());
+
+    // A power loss now only sees the first 4 records
+    {
+        NotificationQueue after_reset("queue");
+        TEST_ASSERT_EQUAL(0, after_reset.open(&fs, 8, MCC_QUEUE_DROP_OLDEST, 4));
+        TEST_ASSERT_EQUAL(4, after_reset.count());
+    }
+
+    // Closing commits the rest
+    q.close();
+    NotificationQueue reopened("queue");
+    TEST_ASSERT_EQUAL(0, reopened.open(&fs, 8, MCC_QUEUE_DROP_OLDEST, 4));
+    TEST_ASSERT_EQUAL(6, reopened.count());
+}
+
+static void test_reused_slot_commits_first() {
+    FileSystem fs("fs");
+    NotificationQueue q("queue");
+    q.open(&fs, 2, MCC_QUEUE_DROP_OLDEST, 8);
+    for (uint16_t i = 0; i < 2; i++) {
+        mcc_queued_record r = make_record(i);
+        q.push(&r);
+    }
+    q.sync();
+    q.pop();
+
+    // The slot of record 0 is reused, so the pop is committed before it is overwritten
+    mcc_queued_record r = make_record(2);
+    TEST_ASSERT_EQUAL(0, q.push(&r));
+
+    NotificationQueue after_reset("queue");
+    TEST_ASSERT_EQUAL(0, after_reset.open(&fs, 2, MCC_QUEUE_DROP_OLDEST, 8));
+    uint32_t numbers[8];
+    TEST_ASSERT_EQUAL(1, drain(after_reset, numbers, 8));
+    TEST_ASSERT_EQUAL(1, numbers[0]);
+}
+
+static void test_full_device_reports_error() {
+    FileSystem fs("fs");
+    NotificationQueue q("queue");
+    q.open(&fs, 4, MCC_QUEUE_DROP_OLDEST);
+
+    fs.set_write_budget(0);
+    mcc_queued_record r = make_record(0);
+    TEST_ASSERT(q.push(&r) < 0);
+    TEST_ASSERT_EQUAL(0, q.count());
+}
+
+int main() {
+    RUN_TEST(test_fifo_order);
+    RUN_TEST(test_survives_reboot);
+    RUN_TEST(test_drop_newest);
+    RUN_TEST(test_downsample_keeps_history_span);
+    RUN_TEST(test_downsample_per_resource);
+    RUN_TEST(test_sync_interval);
+    RUN_TEST(test_reused_slot_commits_first);
+    RUN_TEST(test_full_device_reports_error);
+    return TEST_RESULT();
+}
@@ -0,0 +1,223 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+
+#include "host_test.h"
+#include "notification-scheduler.h"
+
+typedef NotificationScheduler::Entry Entry;
+
+static void make_entries(Entry *e, int count) {
+    // Two of each priority, low first
+    for (int i = 0; i < count; i++) {
+        e[i].owner = &e[i];
+        e[i].priority = i < 2 ? MCC_PRIORITY_LOW : i < 4 ? MCC_PRIORITY_NORMAL : MCC_PRIORITY_HIGH;
+    }
+}
+
+static void test_sends_highest_priority_first() {
+    NotificationScheduler s;
+    s.configure(1, 0);
+    Entry e[6];
+    make_entries(e, 6);
+
+    for (int i = 0; i < 6; i++) {
+        TEST_ASSERT(s.enqueue(&e[i], i) == NULL);
+    }
+    TEST_ASSERT_EQUAL(6, s.pending());
+
+    Entry *order[] = { &e[4], &e[5], &e[2], &e[3], &e[0], &e[1] };
+    for (int i = 0; i < 6; i++) {
+        Entry *next = s.next(0);
+        TEST_ASSERT(next == order[i]);
+        // One in flight at a time
+        TEST_ASSERT(s.next(0) == NULL);
+        s.complete(next, true, 10);
+    }
+    TEST_ASSERT(s.next(0) == NULL);
+}
+
+static void test_sheds_lowest_priority_when_full() {
+    NotificationScheduler s;
+    s.configure(1, 3);
+    Entry e[6];
+    make_entries(e, 6);
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT(s.enqueue(&e[i], i) == NULL);
+    }
+    TEST_ASSERT(s.enqueue(&e[3], 3) == &e[0]);
+    TEST_ASSERT(s.enqueue(&e[4], 4) == &e[1]);
+    TEST_ASSERT(s.enqueue(&e[5], 5) == &e[2]);
+    TEST_ASSERT_EQUAL(3, s.pending());
+
+    TEST_ASSERT_EQUAL(2, s.stats(MCC_PRIORITY_LOW).dropped);
+    TEST_ASSERT_EQUAL(1, s.stats(MCC_PRIORITY_NORMAL).dropped);
+    TEST_ASSERT_EQUAL(0, s.stats(MCC_PRIORITY_HIGH).dropped);
+}
+
+static void test_high_priority_is_never_dropped() {
+    NotificationScheduler s;
+    s.configure(1, 2);
+    Entry e[6];
+    make_entries(e, 6);
+
+    TEST_ASSERT(s.enqueue(&e[4], 0) == NULL);
+    TEST_ASSERT(s.enqueue(&e[5], 0) == NULL);
+    // A normal one is refused, a high one goes over the limit
+    TEST_ASSERT(s.enqueue(&e[2], 0) == &e[2]);
+    Entry extra;
+    extra.priority = MCC_PRIORITY_HIGH;
+    TEST_ASSERT(s.enqueue(&extra, 0) == NULL);
+    TEST_ASSERT_EQUAL(3, s.pending());
+}
+
+static void test_failed_high_priority_send_is_retried_first() {
+    NotificationScheduler s;
+    s.configure(1, 0);
+    Entry e[6];
+    make_entries(e, 6);
+    s.enqueue(&e[4], 0);
+    s.enqueue(&e[5], 0);
+
+    Entry *next = s.next(0);
+    TEST_ASSERT(next == &e[4]);
+    s.complete(next, false, 20);
+    TEST_ASSERT(s.next(0) == &e[4]);
+    s.complete(&e[4], true, 30);
+
+    mcc_priority_stats stats = s.stats(MCC_PRIORITY_HIGH);
+    TEST_ASSERT_EQUAL(2, stats.queued);
+    TEST_ASSERT_EQUAL(2, stats.sent);
+    TEST_ASSERT_EQUAL(1, stats.delivered);
+    TEST_ASSERT_EQUAL(0, stats.dropped);
+    // Measured from the first time it was queued
+    TEST_ASSERT_EQUAL(30, stats.max_latency_ms);
+}
+
+static void test_failed_normal_send_is_dropped() {
+    NotificationScheduler s;
+    s.configure(1, 0);
+    Entry e[6];
+    make_entries(e, 6);
+    s.enqueue(&e[2], 0);
+    s.enqueue(&e[3], 0);
+
+    Entry *next = s.next(0);
+    TEST_ASSERT(next == &e[2]);
+    s.complete(next, false, 20);
+    TEST_ASSERT(s.next(0) == &e[3]);
+    TEST_ASSERT_EQUAL(1, s.stats(MCC_PRIORITY_NORMAL).dropped);
+}
+
+static void test_no_in_flight_limit() {
+    NotificationScheduler s;
+    s.configure(0, 0);
+    TEST_ASSERT_FALSE(s.enabled());
+    Entry e[6];
+    make_entries(e, 6);
+    for (int i = 0; i < 6; i++) {
+        s.enqueue(&e[i], 0);
+    }
+
+    for (int i = 0; i < 6; i++) {
+        TEST_ASSERT(s.next(0) != NULL);
+    }
+    TEST_ASSERT(s.next(0) == NULL);
+}
+
+static void test_remove_unlinks_entry() {
+    NotificationScheduler s;
+    s.configure(1, 0);
+    Entry e[6];
+    make_entries(e, 6);
+    s.enqueue(&e[4], 0);
+    s.enqueue(&e[5], 0);
+
+    s.remove(&e[4]);
+    TEST_ASSERT_EQUAL(1, s.pending());
+    TEST_ASSERT(s.next(0) == &e[5]);
+
+    s.remove(&e[5]);
+    s.enqueue(&e[0], 0);
+    TEST_ASSERT(s.next(0) == &e[0]);
+}
+
+static void test_stale_in_flight_expires() {
+    NotificationScheduler s;
+    s.configure(2, 0);
+    Entry e[6];
+    make_entries(e, 6);
+    s.enqueue(&e[2], 0);
+    s.enqueue(&e[4], 0);
+    s.enqueue(&e[0], 0);
+
+    TEST_ASSERT(s.next(100) == &e[4]);
+    TEST_ASSERT(s.next(200) == &e[2]);
+    TEST_ASSERT(s.next(300) == NULL);
+
+    uint64_t sent_ms = 0;
+    TEST_ASSERT(s.oldest_in_flight(&sent_ms));
+    TEST_ASSERT_EQUAL(100, sent_ms);
+
+    // Only the high priority one is old enough, it is queued again and frees its place
+    TEST_ASSERT_EQUAL(1, s.expire(1100, 1000));
+    TEST_ASSERT(s.next(1100) == &e[4]);
+    TEST_ASSERT_EQUAL(0, s.stats(MCC_PRIORITY_HIGH).dropped);
+
+    // The normal one is dropped, making room for the low one
+    TEST_ASSERT_EQUAL(1, s.expire(1200, 1000));
+    TEST_ASSERT_EQUAL(1, s.stats(MCC_PRIORITY_NORMAL).dropped);
+    TEST_ASSERT(s.next(1200) == &e[0]);
+}
+
+static void test_reset_in_flight_requeues_high_priority() {
+    NotificationScheduler s;
+    s.configure(3, 0);
+    Entry e[6];
+    make_entries(e, 6);
+    s.enqueue(&e[4], 0);
+    s.enqueue(&e[5], 0);
+    s.enqueue(&e[2], 0);
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT(s.next(0) != NULL);
+    }
+
+    s.reset_in_flight();
+    TEST_ASSERT_FALSE(s.oldest_in_flight(NULL));
+    TEST_ASSERT_EQUAL(2, s.pending());
+    TEST_ASSERT_EQUAL(1, s.stats(MCC_PRIORITY_NORMAL).dropped);
+
+    // In the order they were sent
+    TEST_ASSERT(s.next(0) == &e[4]);
+    TEST_ASSERT(s.next(0) == &e[5]);
+    TEST_ASSERT(s.next(0) == NULL);
+}
+
+int main() {
+    RUN_TEST(test_sends_highest_priority_first);
+    RUN_TEST(test_sheds_lowest_priority_when_full);
+    RUN_TEST(test_high_priority_is_never_dropped);
+    RUN_TEST(test_failed_high_priority_send_is_retried_first);
+    RUN_TEST(test_failed_normal_send_is_dropped);
+    RUN_TEST(test_no_in_flight_limit);
+    RUN_TEST(test_remove_unlinks_entry);
+    RUN_TEST(test_stale_in_flight_expires);
+    RUN_TEST(test_reset_in_flight_requeues_high_priority);
+    return TEST_RESULT();
+}
@@ -0,0 +1,232 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+
+// Tests of the policy classes that take time as a parameter
+
+#include "host_test.h"
+#include "notification-coalescer.h"
+#include "reconnect-backoff.h"
+#include "registration-update-debouncer.h"
+#include "wake-window-scheduler.h"
+#include "keepalive-probe.h"
+#include "network-failover.h"
+
+static void test_coalescer_holds_back_within_min_interval() {
+    NotificationCoalescer c;
+    TEST_ASSERT_FALSE(c.enabled());
+    c.configure(1000, 5000, 0.5f);
+    TEST_ASSERT(c.enabled());
+
+    TEST_ASSERT(c.on_write(1.0f, true, 0));
+    c.on_published(1.0f, 0);
+
+    TEST_ASSERT_FALSE(c.on_write(2.0f, true, 100));
+    TEST_ASSERT(c.has_pending());
+    TEST_ASSERT_EQUAL(1000, c.deadline_ms());
+
+    // The held back value is replaced
+    TEST_ASSERT_FALSE(c.on_write(3.0f, true, 200));
+    TEST_ASSERT_EQUAL(1, c.suppressed());
+}
+
+static void test_coalescer_threshold_waits_for_max_interval() {
+    NotificationCoalescer c;
+    c.configure(1000, 5000, 0.5f);
+    c.on_write(3.0f, true, 0);
+    c.on_published(3.0f, 1000);
+
+    TEST_ASSERT_FALSE(c.on_write(3.2f, true, 2500));
+    TEST_ASSERT_EQUAL(6000, c.deadline_ms());
+
+    // A significant change replaces it and goes out at once
+    TEST_ASSERT(c.on_write(4.0f, true, 2600));
+    TEST_ASSERT_EQUAL(1, c.suppressed());
+}
+
+static void test_coalescer_drops_pending_value_within_threshold() {
+    NotificationCoalescer c;
+    c.configure(1000, 0, 0.5f);
+    c.on_write(1.0f, true, 0);
+    c.on_published(1.0f, 0);
+
+    TEST_ASSERT_FALSE(c.on_write(2.0f, true, 100));
+    TEST_ASSERT(c.has_pending());
+
+    // Back within the threshold, neither value is sent
+    TEST_ASSERT_FALSE(c.on_write(1.2f, true, 200));
+    TEST_ASSERT_FALSE(c.has_pending());
+    TEST_ASSERT_EQUAL(2, c.suppressed());
+
+    // With a maximum interval the replacement waits for it
+    c.configure(1000, 5000, 0.5f);
+    TEST_ASSERT_FALSE(c.on_write(2.0f, true, 300));
+    TEST_ASSERT_EQUAL(1000, c.deadline_ms());
+    TEST_ASSERT_FALSE(c.on_write(1.2f, true, 400));
+    TEST_ASSERT(c.has_pending());
+    TEST_ASSERT_EQUAL(5000, c.deadline_ms());
+    TEST_ASSERT_EQUAL(3, c.suppressed());
+}
+
+static void test_backoff_grows_and_exhausts() {
+    ReconnectBackoff b;
+    b.configure(1000, 60000, 5, 3000);
+    b.seed(42);
+
+    uint64_t now = 0;
+    uint64_t cap = 1000;
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT(b.on_failure(now));
+        TEST_ASSERT(b.pending());
+        TEST_ASSERT(b.next_attempt_ms() - now <= cap);
+        now = b.next_attempt_ms();
+        b.on_attempt();
+        cap *= 2;
+    }
+
+    TEST_ASSERT_FALSE(b.on_failure(now));
+    TEST_ASSERT(b.exhausted());
+    TEST_ASSERT_EQUAL(5, b.attempts());
+}
+
+static void test_backoff_waits_for_link() {
+    ReconnectBackoff b;
+    b.configure(1000, 60000, 5, 3000);
+    b.seed(42);
+
+    b.on_link_down();
+    TEST_ASSERT_FALSE(b.on_failure(0));
+    TEST_ASSERT(b.on_link_up(100));
+    TEST_ASSERT(b.next_attempt_ms() - 100 <= 3000);
+}
+
+static void test_debouncer_merges_requests() {
+    RegistrationUpdateDebouncer d;
+    d.configure(100);
+
+    TEST_ASSERT_FALSE(d.on_request(0));
+    TEST_ASSERT_FALSE(d.on_request(50));
+    TEST_ASSERT(d.on_timer(100));
+
+    // Requests while an update is in flight wait for it to complete
+    TEST_ASSERT_FALSE(d.on_request(120));
+    TEST_ASSERT_FALSE(d.on_timer(220));
+    TEST_ASSERT(d.on_completed(300));
+
+    TEST_ASSERT_EQUAL(2, d.issued());
+    TEST_ASSERT_EQUAL(1, d.merged());
+    TEST_ASSERT(d.in_flight());
+}
+
+static void test_wake_window_counts_messages() {
+    WakeWindowScheduler w;
+    TEST_ASSERT_FALSE(w.enabled());
+    w.configure(1000);
+
+    w.on_wake(10);
+    TEST_ASSERT(w.is_open());
+    w.on_message();
+    w.on_message();
+    w.on_sleep(60);
+    TEST_ASSERT_FALSE(w.is_open());
+
+    mcc_wake_window_stats s = w.stats();
+    TEST_ASSERT_EQUAL(1, s.windows);
+    TEST_ASSERT_EQUAL(2, s.last_messages);
+    TEST_ASSERT_EQUAL(50, s.last_awake_ms);
+    TEST_ASSERT_EQUAL(1010, w.next_window_ms());
+
+    // Messages outside a window are not counted
+    w.on_message();
+    TEST_ASSERT_EQUAL(2, w.stats().messages);
+}
+
+static void run_probe(KeepAliveProbe &p, uint32_t nat_timeout_ms) {
+    for (int i = 0; i < 50 && !p.converged(); i++) {
+        uint32_t interval = p.next_interval();
+        p.on_result(interval, interval <= nat_timeout_ms);
+    }
+}
+
+static void test_keepalive_finds_nat_timeout() {
+    KeepAliveProbe p;
+    p.configure(30000, 2700000, 15000);
+    run_probe(p, 170000);
+
+    TEST_ASSERT(p.converged());
+    TEST_ASSERT(p.good_ms() <= 170000);
+    TEST_ASSERT(p.bad_ms() > 170000);
+    TEST_ASSERT(p.bad_ms() - p.good_ms() <= 15000);
+    TEST_ASSERT(p.next_interval() <= p.good_ms());
+}
+
+static void test_keepalive_relearns_shorter_timeout() {
+    KeepAliveProbe p;
+    p.configure(30000, 2700000, 15000);
+    run_probe(p, 170000);
+
+    // The NAT now drops the binding sooner, the learned interval fails
+    p.on_result(p.next_interval(), false);
+    TEST_ASSERT_FALSE(p.converged());
+    run_probe(p, 60000);
+
+    TEST_ASSERT(p.converged());
+    TEST_ASSERT(p.good_ms() <= 60000);
+    TEST_ASSERT(p.bad_ms() > 60000);
+}
+
+static void test_failover_switches_and_recovers() {
+    NetworkFailover f;
+    f.configure(2, 3);
+    TEST_ASSERT_EQUAL(0, f.add());
+    TEST_ASSERT_EQUAL(1, f.add());
+    TEST_ASSERT_EQUAL(-1, f.next());
+
+    f.on_probe(0, false);
+    TEST_ASSERT_EQUAL(-1, f.next());
+    f.on_probe(0, false);
+    TEST_ASSERT_EQUAL(1, f.next());
+    f.on_switched(1);
+    TEST_ASSERT_EQUAL(1, f.active());
+
+    // The preferred interface needs an unbroken streak of healthy probes
+    f.on_probe(0, true);
+    f.on_probe(0, true);
+    TEST_ASSERT_EQUAL(-1, f.next());
+    f.on_probe(0, false);
+    f.on_probe(0, true);
+    f.on_probe(0, true);
+    f.on_probe(0, true);
+    TEST_ASSERT_EQUAL(0, f.next());
+    f.on_switched(0);
+    TEST_ASSERT_EQUAL(2, f.switches());
+}
+
+int main() {
+    RUN_TEST(test_coalescer_holds_back_within_min_interval);
+    RUN_TEST(test_coalescer_threshold_waits_for_max_interval);
+    RUN_TEST(test_coalescer_drops_pending_value_within_threshold);
+    RUN_TEST(test_backoff_grows_and_exhausts);
+    RUN_TEST(test_backoff_waits_for_link);
+    RUN_TEST(test_debouncer_merges_requests);
+    RUN_TEST(test_wake_window_counts_messages);
+    RUN_TEST(test_keepalive_finds_nat_timeout);
+    RUN_TEST(test_keepalive_relearns_shorter_timeout);
+    RUN_TEST(test_failover_switches_and_recovers);
+    return TEST_RESULT();
+}
@@ -0,0 +1,117 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+
+#include "host_test.h"
+#include "mbed.h"
+#include "FileSystem.h"
+#include "resource-stream.h"
+
+static void test_sink_writes_file_and_checksum() {
+    FileSystem fs("fs");
+    ResourceFileSink sink("payload");
+    TEST_ASSERT_EQUAL(0, sink.begin(&fs));
+    TEST_ASSERT(sink.is_open());
+
+    // CRC-32 check value, written in two blocks
+    TEST_ASSERT_EQUAL(0, sink.write((const uint8_t *)"1234", 4));
+    TEST_ASSERT_EQUAL(0, sink.write((const uint8_t *)"56789", 5));
+    TEST_ASSERT_EQUAL(0, sink.finish());
+    TEST_ASSERT_FALSE(sink.is_open());
+    TEST_ASSERT_EQUAL(9, sink.size());
+    TEST_ASSERT_EQUAL(0xCBF43926, sink.checksum());
+
+    File file;
+    TEST_ASSERT_EQUAL(0, file.open(&fs, "payload", O_RDONLY));
+    TEST_ASSERT_EQUAL(9, file.size());
+}
+
+static void test_sink_removes_partial_file() {
+    FileSystem fs("fs");
+    ResourceFileSink sink("payload");
+    sink.begin(&fs);
+    sink.write((const uint8_t *)"1234", 4);
+
+    fs.set_write_budget(2);
+    TEST_ASSERT(sink.write((const uint8_t *)"5678", 4) < 0);
+    TEST_ASSERT_FALSE(sink.is_open());
+
+    File file;
+    TEST_ASSERT(file.open(&fs, "payload", O_RDONLY) < 0);
+}
+
+static void test_sink_failed_begin_resets_size() {
+    FileSystem fs("fs");
+    ResourceFileSink sink("payload");
+    sink.begin(&fs);
+    sink.write((const uint8_t *)"1234", 4);
+    TEST_ASSERT_EQUAL(0, sink.finish());
+    TEST_ASSERT_EQUAL(4, sink.size());
+
+    TEST_ASSERT(sink.begin(NULL) < 0);
+    TEST_ASSERT_EQUAL(0, sink.size());
+    TEST_ASSERT_EQUAL(0, sink.checksum());
+}
+
+static void test_source_serves_window() {
+    FileSystem fs("fs");
+    File file;
+    file.open(&fs, "log", O_WRONLY | O_CREAT);
+    file.write("abcdefghij", 10);
+    file.close();
+
+    ResourceFileSource source("log", 4);
+    size_t size = 0;
+    TEST_ASSERT_EQUAL(0, source.size(&fs, &size));
+    TEST_ASSERT_EQUAL(4, size);
+
+    char buffer[16];
+    size_t length = sizeof(buffer);
+    TEST_ASSERT_EQUAL(0, source.read(&fs, buffer, &length));
+    TEST_ASSERT_EQUAL(4, length);
+    TEST_ASSERT_EQUAL_MEMORY("abcd", buffer, 4);
+
+    // The last window is shorter
+    source.set_offset(8);
+    TEST_ASSERT_EQUAL(0, source.size(&fs, &size));
+    TEST_ASSERT_EQUAL(2, size);
+    length = sizeof(buffer);
+    TEST_ASSERT_EQUAL(0, source.read(&fs, buffer, &length));
+    TEST_ASSERT_EQUAL(2, length);
+    TEST_ASSERT_EQUAL_MEMORY("ij", buffer, 2);
+
+    source.set_offset(20);
+    TEST_ASSERT_EQUAL(0, source.size(&fs, &size));
+    TEST_ASSERT_EQUAL(0, size);
+}
+
+static void test_source_missing_file() {
+    FileSystem fs("fs");
+    ResourceFileSource source("missing", 4);
+    size_t size = 0;
+    TEST_ASSERT(source.size(&fs, &size) < 0);
+}
+
+int main() {
+    RUN_TEST(test_sink_writes_file_and_checksum);
+    RUN_TEST(test_sink_removes_partial_file);
+    RUN_TEST(test_sink_failed_begin_resets_size);
+    RUN_TEST(test_source_serves_window);
+    RUN_TEST(test_source_missing_file);
+    return TEST_RESULT();
+}
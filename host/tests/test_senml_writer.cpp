@@ -0,0 +1,87 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+
+#include "host_test.h"
+#include "senml-writer.h"
+
+static void test_json_pack() {
+    uint8_t buffer[128];
+    SenmlWriter w(SenmlWriter::JSON, buffer, sizeof(buffer));
+    w.begin(2);
+    w.add("/3303/0/5700", 1500000000, 0.0f, 21.5f);
+    w.add(NULL, 0, 10.0f, 22.0f);
+    size_t length = w.end();
+
+    const char *expected = "[{\"bn\":\"/3303/0/5700\",\"bt\":1500000000,\"t\":0,\"v\":21.5},{\"t\":10,\"v\":22}]";
+    TEST_ASSERT_EQUAL(strlen(expected), length);
+    TEST_ASSERT_EQUAL_MEMORY(expected, buffer, length);
+}
+
+static void test_cbor_pack() {
+    uint8_t buffer[64];
+    SenmlWriter w(SenmlWriter::CBOR, buffer, sizeof(buffer));
+    w.begin(1);
+    w.add("a", 0, 0.0f, 1.0f);
+    size_t length = w.end();
+
+    const uint8_t expected[] = {
+        0x81,                               // array(1)
+        0xa3,                               // map(3)
+        0x21, 0x61, 'a',                    // bn: "a"
+        0x06, 0xfa, 0x00, 0x00, 0x00, 0x00, // t: 0.0
+        0x02, 0xfa, 0x3f, 0x80, 0x00, 0x00  // v: 1.0
+    };
+    TEST_ASSERT_EQUAL(sizeof(expected), length);
+    TEST_ASSERT_EQUAL_MEMORY(expected, buffer, length);
+}
+
+static void test_cbor_large_count_and_base_time() {
+    uint8_t buffer[64];
+    SenmlWriter w(SenmlWriter::CBOR, buffer, sizeof(buffer));
+    w.begin(300);
+    w.add(NULL, -1000, 0.0f, 0.0f);
+
+    const uint8_t expected[] = {
+        0x99, 0x01, 0x2c,                   // array(300)
+        0xa3,                               // map(3)
+        0x22, 0x39, 0x03, 0xe7              // bt: -1000
+    };
+    TEST_ASSERT_EQUAL_MEMORY(expected, buffer, sizeof(expected));
+}
+
+static void test_overflow_returns_zero() {
+    uint8_t buffer[16];
+    SenmlWriter json(SenmlWriter::JSON, buffer, sizeof(buffer));
+    json.begin(1);
+    json.add("/3303/0/5700", 0, 0.0f, 1.0f);
+    TEST_ASSERT_EQUAL(0, json.end());
+
+    SenmlWriter cbor(SenmlWriter::CBOR, buffer, 8);
+    cbor.begin(1);
+    cbor.add(NULL, 0, 1.0f, 2.0f);
+    TEST_ASSERT_EQUAL(0, cbor.end());
+}
+
+int main() {
+    RUN_TEST(test_json_pack);
+    RUN_TEST(test_cbor_pack);
+    RUN_TEST(test_cbor_large_count_and_base_time);
+    RUN_TEST(test_overflow_returns_zero);
+    return TEST_RESULT();
+}
@@ -0,0 +1,343 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "dns-cache.h"
+#include "mbed_trace.h"
+#include <errno.h>
+
+#define TRACE_GROUP "SMCD"
+
+#define DNS_CACHE_MAGIC 0x44434d53 // "SMCD"
+
+// Before this time(NULL), the clock was not set and the age of an entry is not known
+#define DNS_CACHE_MIN_TIME (1UL << 28)
+
+DnsCacheInterface::DnsCacheInterface(const char *path)
+    : _path(NULL), _fs(NULL), _net(NULL), _ttl_s(0), _count(0), _resolving(false), _resolve_id(0), _resolve_start_ms(0)
+{
+    size_t len = strlen(path);
+    _path = new char[len + 1];
+    memcpy(_path, path, len + 1);
+
+    memset(_entries, 0, sizeof(_entries));
+    memset(_resolve_host, 0, sizeof(_resolve_host));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+DnsCacheInterface::~DnsCacheInterface() {
+    delete[] _path;
+}
+
+void DnsCacheInterface::set_interface(NetworkInterface *net) {
+    _net = net;
+}
+
+int DnsCacheInterface::open(FileSystem *fs, uint32_t ttl_s) {
+    if (!fs) return -1;
+
+    _mutex.lock();
+    _fs = fs;
+    _ttl_s = ttl_s;
+    _count = 0;
+
+    File file;
+    int status = file.open(fs, _path, O_RDONLY);
+    if (status == 0) {
+        header h;
+        if (file.read(&h, sizeof(h)) == (ssize_t)sizeof(h) &&
+            h.magic == DNS_CACHE_MAGIC && h.entry_size == sizeof(entry) && h.count <= DNS_CACHE_ENTRIES) {
+            ssize_t size = h.count * sizeof(entry);
+            if (file.read(_entries, size) == size) {
+                _count = h.count;
+            }
+        }
+        file.close();
+    }
+    _mutex.unlock();
+
+    tr_debug("%lu cached host names", (unsigned long)_count);
+
+    // A missing file is an empty cache
+    return (status == 0 || status == -ENOENT) ? 0 : status;
+}
+
+void DnsCacheInterface::clear() {
+    _mutex.lock();
+    _count = 0;
+    if (_fs) {
+        _fs->remove(_path);
+    }
+    _mutex.unlock();
+}
+
+mcc_dns_stats DnsCacheInterface::stats() {
+    _mutex.lock();
+    mcc_dns_stats stats = _stats;
+    _mutex.unlock();
+    return stats;
+}
+
+nsapi_error_t DnsCacheInterface::connect() {
+    return _net->connect();
+}
+
+nsapi_error_t DnsCacheInterface::disconnect() {
+    return _net->disconnect();
+}
+
+const char *DnsCacheInterface::get_ip_address() {
+    return _net->get_ip_address();
+}
+
+const char *DnsCacheInterface::get_mac_address() {
+    return _net->get_mac_address();
+}
+
+const char *DnsCacheInterface::get_netmask() {
+    return _net->get_netmask();
+}
+
+const char *DnsCacheInterface::get_gateway() {
+    return _net->get_gateway();
+}
+
+nsapi_error_t DnsCacheInterface::gethostbyname(const char *host, SocketAddress *address, nsapi_version_t version) {
+    // Literal addresses and long names are not cached
+    SocketAddress literal;
+    if (literal.set_ip_address(host) || strlen(host) >= DNS_CACHE_HOST_SIZE) {
+        return _net->gethostbyname(host, address, version);
+    }
+
+    _mutex.lock();
+    _stats.lookups++;
+    int index = find(host, version);
+    if (index >= 0) {
+        _stats.hits++;
+        address->set_addr(_entries[index].addr);
+        bool fresh = is_fresh(_entries[index]);
+        _mutex.unlock();
+
+        if (!fresh) {
+            resolve(host, version, hostbyname_cb_t());
+        }
+        return NSAPI_ERROR_OK;
+    }
+    _mutex.unlock();
+
+    uint64_t start = Kernel::get_ms_count();
+    nsapi_error_t status = _net->gethostbyname(host, address, version);
+    uint32_t elapsed = (uint32_t)(Kernel::get_ms_count() - start);
+
+    _mutex.lock();
+    _stats.resolve_ms += elapsed;
+    if (status == NSAPI_ERROR_OK) {
+        store(host, address->get_addr());
+    }
+    _mutex.unlock();
+
+    if (status == NSAPI_ERROR_OK) {
+        save();
+    }
+    return status;
+}
+
+nsapi_value_or_error_t DnsCacheInterface::gethostbyname_async(const char *host, hostbyname_cb_t callback,
+                                                              nsapi_version_t version) {
+    // Literal addresses and long names are not cached
+    SocketAddress address;
+    if (address.set_ip_address(host) || strlen(host) >= DNS_CACHE_HOST_SIZE) {
+        return _net->gethostbyname_async(host, callback, version);
+    }
+
+    _mutex.lock();
+    _stats.lookups++;
+    int index = find(host, version);
+    if (index >= 0) {
+        _stats.hits++;
+        address.set_addr(_entries[index].addr);
+        bool fresh = is_fresh(_entries[index]);
+        _mutex.unlock();
+
+        // Answered in the context of the call, like a literal address
+        callback(NSAPI_ERROR_OK, &address);
+        if (!fresh) {
+            resolve(host, version, hostbyname_cb_t());
+        }
+        return NSAPI_ERROR_OK;
+    }
+    _mutex.unlock();
+
+    nsapi_value_or_error_t id = resolve(host, version, callback);
+    if (id == NSAPI_ERROR_BUSY) {
+        return _net->gethostbyname_async(host, callback, version);
+    }
+    return id;
+}
+
+nsapi_error_t DnsCacheInterface::gethostbyname_async_cancel(int id) {
+    _mutex.lock();
+    if (_resolving && id > 0 && id == _resolve_id) {
+        // The answer still goes into the cache, it is only not passed on
+        _resolve_cb = hostbyname_cb_t();
+        _mutex.unlock();
+        return NSAPI_ERROR_OK;
+    }
+    _mutex.unlock();
+
+    return _net->gethostbyname_async_cancel(id);
+}
+
+void DnsCacheInterface::attach(mbed::Callback<void(nsapi_event_t, intptr_t)> status_cb) {
+    _net->attach(status_cb);
+}
+
+nsapi_connection_status_t DnsCacheInterface::get_connection_status() const {
+    return _net->get_connection_status();
+}
+
+nsapi_error_t DnsCacheInterface::set_blocking(bool blocking) {
+    return _net->set_blocking(blocking);
+}
+
+NetworkStack *DnsCacheInterface::get_stack() {
+    return nsapi_create_stack(_net);
+}
+
+int DnsCacheInterface::find(const char *host, nsapi_version_t version) {
+    for (uint32_t i = 0; i < _count; i++) {
+        if (strcmp(_entries[i].host, host) == 0 &&
+            (version == NSAPI_UNSPEC || _entries[i].addr.version == version)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void DnsCacheInterface::store(const char *host, const nsapi_addr_t &addr) {
+    uint32_t now = (uint32_t)time(NULL);
+
+    // Replace the entry of the host, or else the oldest one when the cache is full
+    uint32_t index = 0;
+    while (index < _count && strcmp(_entries[index].host, host) != 0) {
+        index++;
+    }
+    if (index == _count) {
+        if (_count < DNS_CACHE_ENTRIES) {
+            _count++;
+        } else {
+            index = 0;
+            for (uint32_t i = 1; i < _count; i++) {
+                if (_entries[i].resolved_at < _entries[index].resolved_at) {
+                    index = i;
+                }
+            }
+        }
+    }
+
+    strncpy(_entries[index].host, host, DNS_CACHE_HOST_SIZE - 1);
+    _entries[index].host[DNS_CACHE_HOST_SIZE - 1] = 0;
+    _entries[index].addr = addr;
+    _entries[index].resolved_at = now;
+}
+
+bool DnsCacheInterface::is_fresh(const entry &e) {
+    uint32_t now = (uint32_t)time(NULL);
+    if (now < DNS_CACHE_MIN_TIME || now < e.resolved_at) {
+        return false;
+    }
+    return now - e.resolved_at < _ttl_s;
+}
+
+nsapi_value_or_error_t DnsCacheInterface::resolve(const char *host, nsapi_version_t version, hostbyname_cb_t cb) {
+    // One lookup at a time, other refreshes wait for a later lookup
+    _mutex.lock();
+    if (_resolving) {
+        _mutex.unlock();
+        return NSAPI_ERROR_BUSY;
+    }
+    _resolving = true;
+    _resolve_cb = cb;
+    _resolve_id = 0;
+    _resolve_start_ms = Kernel::get_ms_count();
+    strncpy(_resolve_host, host, DNS_CACHE_HOST_SIZE - 1);
+    _mutex.unlock();
+
+    // The callback may run before this returns, so the mutex is not held
+    nsapi_value_or_error_t id = _net->gethostbyname_async(_resolve_host,
+                                                          callback(this, &DnsCacheInterface::resolve_done), version);
+
+    _mutex.lock();
+    if (id < 0) {
+        tr_debug("Could not resolve %s (%d)", host, (int)id);
+        _resolving = false;
+        _resolve_cb = hostbyname_cb_t();
+    } else if (_resolving) {
+        _resolve_id = id;
+    }
+    _mutex.unlock();
+    return id;
+}
+
+void DnsCacheInterface::resolve_done(nsapi_error_t result, SocketAddress *address) {
+    _mutex.lock();
+    hostbyname_cb_t cb = _resolve_cb;
+    if (result == NSAPI_ERROR_OK) {
+        store(_resolve_host, address->get_addr());
+    } else {
+        // A refreshed entry keeps its cached address
+        tr_debug("Resolving %s failed (%d)", _resolve_host, (int)result);
+    }
+    if (cb) {
+        _stats.resolve_ms += (uint32_t)(Kernel::get_ms_count() - _resolve_start_ms);
+    } else if (result == NSAPI_ERROR_OK) {
+        _stats.refreshes++;
+    }
+    _resolving = false;
+    _resolve_cb = hostbyname_cb_t();
+    _resolve_id = 0;
+    _mutex.unlock();
+
+    if (result == NSAPI_ERROR_OK) {
+        // The callback runs in the network stack, write the file from the shared event queue
+        mbed_event_queue()->call(callback(this, &DnsCacheInterface::save));
+    }
+
+    if (cb) {
+        cb(result, address);
+    }
+}
+
+void DnsCacheInterface::save() {
+    if (!_fs) return;
+
+    _mutex.lock();
+    File file;
+    int status = file.open(_fs, _path, O_WRONLY | O_CREAT | O_TRUNC);
+    if (status == 0) {
+        header h;
+        h.magic = DNS_CACHE_MAGIC;
+        h.entry_size = sizeof(entry);
+        h.count = _count;
+        file.write(&h, sizeof(h));
+        file.write(_entries, _count * sizeof(entry));
+        file.close();
+    } else {
+        tr_warn("Could not write %s (%d)", _path, status);
+    }
+    _mutex.unlock();
+}
@@ -0,0 +1,140 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+#include "mbed.h"
+#include "FileSystem.h"
+#include "NetworkInterface.h"
+
+// Number of host names kept, the bootstrap and LwM2M servers need two
+#define DNS_CACHE_ENTRIES 4
+
+// Longest host name that is cached, including the terminating zero
+#define DNS_CACHE_HOST_SIZE 64
+
+/**
+ * Counters of the DNS cache
+ */
+struct mcc_dns_stats {
+    uint32_t lookups;           // Host names looked up
+    uint32_t hits;              // Lookups answered from the cache
+    uint32_t resolve_ms;        // Time spent waiting for the DNS server
+    uint32_t refreshes;         // Cached addresses refreshed in the background
+};
+
+/**
+ * Network interface that answers host name lookups from a cache kept in a file.
+ *
+ * All calls are passed to the wrapped interface, except gethostbyname and
+ * gethostbyname_async. A cached address is returned at once, gethostbyname_async
+ * calls back before it returns 0; when the address is older than the TTL, or its age
+ * is not known because the clock is not set, it is also resolved again in the background
+ * for the next lookup. Only host names that are not cached wait for the DNS server.
+ * One lookup at a time goes through the cache, an asynchronous lookup made while
+ * another one runs is passed to the wrapped interface and not cached.
+ * The DNS server does not report the TTL of its answers, so a fixed TTL is used.
+ */
+class DnsCacheInterface : public NetworkInterface {
+public:
+    /**
+     * @param path Path of the file, relative to the file system, copied
+     */
+    DnsCacheInterface(const char *path);
+
+    ~DnsCacheInterface();
+
+    /**
+     * Set the interface that lookups and all other calls are passed to
+     */
+    void set_interface(NetworkInterface *net);
+
+    /**
+     * Load the cache from the file
+     *
+     * @param fs File system that holds the file
+     * @param ttl_s Age in seconds after which a cached address is refreshed
+     *
+     * @returns 0 if successful, non-0 when the file could not be read or created
+     */
+    int open(FileSystem *fs, uint32_t ttl_s);
+
+    /**
+     * Forget all cached addresses, and remove the file
+     */
+    void clear();
+
+    /**
+     * Counters since boot
+     */
+    mcc_dns_stats stats();
+
+    virtual nsapi_error_t connect();
+    virtual nsapi_error_t disconnect();
+    virtual const char *get_ip_address();
+    virtual const char *get_mac_address();
+    virtual const char *get_netmask();
+    virtual const char *get_gateway();
+    virtual nsapi_error_t gethostbyname(const char *host, SocketAddress *address, nsapi_version_t version = NSAPI_UNSPEC);
+    virtual nsapi_value_or_error_t gethostbyname_async(const char *host, hostbyname_cb_t callback,
+                                                       nsapi_version_t version = NSAPI_UNSPEC);
+    virtual nsapi_error_t gethostbyname_async_cancel(int id);
+    virtual void attach(mbed::Callback<void(nsapi_event_t, intptr_t)> status_cb);
+    virtual nsapi_connection_status_t get_connection_status() const;
+    virtual nsapi_error_t set_blocking(bool blocking);
+
+protected:
+    virtual NetworkStack *get_stack();
+
+private:
+    struct entry {
+        char host[DNS_CACHE_HOST_SIZE];
+        nsapi_addr_t addr;
+        uint32_t resolved_at;           // time(NULL) of the lookup
+    };
+
+    struct header {
+        uint32_t magic;
+        uint32_t entry_size;
+        uint32_t count;
+    };
+
+    int find(const char *host, nsapi_version_t version);
+    void store(const char *host, const nsapi_addr_t &addr);
+    bool is_fresh(const entry &e);
+    nsapi_value_or_error_t resolve(const char *host, nsapi_version_t version, hostbyname_cb_t cb);
+    void resolve_done(nsapi_error_t result, SocketAddress *address);
+    void save();
+
+    char *_path;
+    FileSystem *_fs;
+    NetworkInterface *_net;
+    uint32_t _ttl_s;
+    entry _entries[DNS_CACHE_ENTRIES];
+    uint32_t _count;
+    bool _resolving;                    // A background lookup runs, a refresh when _resolve_cb is not set
+    char _resolve_host[DNS_CACHE_HOST_SIZE];
+    hostbyname_cb_t _resolve_cb;
+    int _resolve_id;
+    uint64_t _resolve_start_ms;
+    mcc_dns_stats _stats;
+    Mutex _mutex;
+};
+
+#endif // DNS_CACHE_H
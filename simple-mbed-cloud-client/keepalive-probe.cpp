@@ -0,0 +1,103 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "keepalive-probe.h"
+
+KeepAliveProbe::KeepAliveProbe()
+    : _min_ms(0),
+      _max_ms(0),
+      _resolution_ms(0),
+      _good_ms(0),
+      _bad_ms(0),
+      _probes(0)
+{
+}
+
+void KeepAliveProbe::configure(uint32_t min_ms, uint32_t max_ms, uint32_t resolution_ms) {
+    _min_ms = min_ms;
+    _max_ms = max_ms > min_ms ? max_ms : min_ms;
+    _resolution_ms = resolution_ms > 0 ? resolution_ms : 1;
+    _good_ms = _min_ms;
+    _bad_ms = 0;
+}
+
+void KeepAliveProbe::restore(uint32_t good_ms, uint32_t bad_ms) {
+    if (good_ms < _min_ms) good_ms = _min_ms;
+    if (good_ms > _max_ms) good_ms = _max_ms;
+    if (bad_ms != 0 && bad_ms <= good_ms) bad_ms = 0;
+
+    _good_ms = good_ms;
+    _bad_ms = bad_ms;
+}
+
+bool KeepAliveProbe::converged() const {
+    if (_good_ms >= _max_ms) return true;
+    return _bad_ms != 0 && _bad_ms - _good_ms <= _resolution_ms;
+}
+
+uint32_t KeepAliveProbe::next_interval() const {
+    if (converged()) {
+        // Stay a resolution step below the bad interval, the binding time varies a little
+        if (_bad_ms != 0 && _good_ms > _min_ms + _resolution_ms) {
+            return _good_ms - _resolution_ms;
+        }
+        return _good_ms;
+    }
+
+    uint32_t bad = _bad_ms != 0 ? _bad_ms : _max_ms;
+    uint32_t interval = _good_ms + (bad - _good_ms) / 2;
+    return interval > _good_ms ? interval : bad;
+}
+
+void KeepAliveProbe::on_result(uint32_t interval_ms, bool reachable) {
+    _probes++;
+
+    if (reachable) {
+        if (interval_ms > _good_ms) {
+            _good_ms = interval_ms < _max_ms ? interval_ms : _max_ms;
+        }
+        if (_bad_ms != 0 && _bad_ms <= _good_ms) {
+            // The binding got longer
+            _bad_ms = 0;
+        }
+        return;
+    }
+
+    if (_bad_ms == 0 || interval_ms < _bad_ms) {
+        _bad_ms = interval_ms;
+    }
+    if (_good_ms >= _bad_ms) {
+        // The binding got shorter, nothing above the minimum is known to be safe any more
+        _good_ms = _min_ms;
+        if (_bad_ms <= _good_ms) {
+            _bad_ms = 0;
+        }
+    }
+}
+
+uint32_t KeepAliveProbe::good_ms() const {
+    return _good_ms;
+}
+
+uint32_t KeepAliveProbe::bad_ms() const {
+    return _bad_ms;
+}
+
+uint32_t KeepAliveProbe::probes() const {
+    return _probes;
+}
@@ -0,0 +1,98 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef KEEPALIVE_PROBE_H
+#define KEEPALIVE_PROBE_H
+
+#include <stdint.h>
+
+/**
+ * Learns how long a NAT binding survives an idle connection.
+ *
+ * The search keeps the longest idle interval after which the server was
+ * still reachable ('good') and the shortest one after which it was not
+ * ('bad'), and probes halfway between them until they are within the
+ * resolution. A failure at or below the good interval means the binding
+ * got shorter, and restarts the search from the minimum.
+ *
+ * This class does not depend on Mbed OS, the caller runs the probes.
+ */
+class KeepAliveProbe {
+public:
+    KeepAliveProbe();
+
+    /**
+     * Configure the search range, and start a new search
+     *
+     * @param min_ms Shortest interval, assumed to be safe
+     * @param max_ms Longest interval, there is no need to keep alive beyond it
+     * @param resolution_ms The search ends when the good and bad intervals are this close
+     */
+    void configure(uint32_t min_ms, uint32_t max_ms, uint32_t resolution_ms);
+
+    /**
+     * Continue a search, e.g. from a previous boot
+     *
+     * @param good_ms Longest interval known to be reachable
+     * @param bad_ms Shortest interval known not to be reachable, 0 if none
+     */
+    void restore(uint32_t good_ms, uint32_t bad_ms);
+
+    /**
+     * Whether the search has ended
+     */
+    bool converged() const;
+
+    /**
+     * Idle interval before the next keep-alive, a probe while searching
+     */
+    uint32_t next_interval() const;
+
+    /**
+     * Record the outcome of a keep-alive
+     *
+     * @param interval_ms Idle interval before the keep-alive
+     * @param reachable Whether the server was still reachable
+     */
+    void on_result(uint32_t interval_ms, bool reachable);
+
+    /**
+     * Longest interval known to be reachable
+     */
+    uint32_t good_ms() const;
+
+    /**
+     * Shortest interval known not to be reachable, 0 if none
+     */
+    uint32_t bad_ms() const;
+
+    /**
+     * Number of results recorded
+     */
+    uint32_t probes() const;
+
+private:
+    uint32_t _min_ms;
+    uint32_t _max_ms;
+    uint32_t _resolution_ms;
+    uint32_t _good_ms;
+    uint32_t _bad_ms;
+    uint32_t _probes;
+};
+
+#endif // KEEPALIVE_PROBE_H
@@ -19,52 +19,179 @@
 #include "mbed.h"
 #include "mbed-cloud-client-resource.h"
 #include "simple-mbed-cloud-client.h"
+#include "mbed_trace.h"
+#include "mbed-client/m2mobjectinstance.h"
+#include "mbed-client/m2mreporthandler.h"
+
+#define TRACE_GROUP "SMCR"
+
+// set_value_raw() takes ownership of the buffer and frees the previous value
+static void set_value_raw_copy(M2MResource *res, const char *data, uint32_t length) {
+    uint8_t *copy = (uint8_t*)malloc(length + 1);
+    if (!copy) {
+        tr_error("Could not allocate %lu bytes for resource value", (unsigned long)(length + 1));
+        return;
+    }
+    if (length > 0) {
+        memcpy(copy, data, length);
+    }
+    copy[length] = '\0';
+    res->set_value_raw(copy, length);
+}
 
-void path_to_ids(const char* path, unsigned int *object_id,
-                 unsigned int *instance_id, unsigned int *resource_id) {
-    int len = strlen(path);
-    char *buffer = new char[len + 1];
-    buffer[len] = '\0';
-    strncpy(buffer, path, len);
-    unsigned int index = 0;
-    char * pch = strtok (buffer, "/");
-
-    unsigned int *ptr;
-    while (pch != NULL && index < 3) {
-        switch (index) {
-            case 0:
-                ptr = object_id;
-            break;
-
-            case 1:
-                ptr = instance_id;
-            break;
-
-            case 2:
-                ptr = resource_id;
-            break;
-        }
+// Formats without printf, as %lld is not available in newlib-nano
+static int int64_to_string(int64_t value, char *str) {
+    char digits[20];
+    int count = 0;
+    uint64_t magnitude = value < 0 ? (uint64_t)(-(value + 1)) + 1 : (uint64_t)value;
+
+    do {
+        digits[count++] = '0' + (magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
 
-        *ptr = atoi(pch);
-        pch = strtok (NULL, "/");
-        index++;
+    int length = 0;
+    if (value < 0) {
+        str[length++] = '-';
     }
+    while (count) {
+        str[length++] = digits[--count];
+    }
+    str[length] = '\0';
 
-    delete[] buffer;
+    return length;
 }
 
-MbedCloudClientResource::MbedCloudClientResource(SimpleMbedCloudClient *client, const char *path, const char *name)
+// Parses "3200/0/5501" in place, without copying or tokenizing the path
+static void path_to_ids(const char* path, uint16_t *object_id,
+                        uint16_t *instance_id, uint16_t *resource_id) {
+    uint16_t *ids[3] = { object_id, instance_id, resource_id };
+
+    for (unsigned int index = 0; index < 3; index++) {
+        while (*path == '/') path++;
+        if (*path == '\0') break;
+
+        char *end;
+        *ids[index] = (uint16_t)strtoul(path, &end, 10);
+        path = end;
+    }
+}
+
+MbedCloudClientResource::MbedCloudClientResource(SimpleMbedCloudClient *client, const char *path, const char *name,
+                                                 M2MResourceInstance::ResourceType type)
 : client(client),
+  next(NULL),
+  managed(false),
+  resource(NULL),
+  objectId(0),
+  instanceId(0),
+  resourceId(0),
+  name(NULL),
+  ownsName(true),
+  value(NULL),
+  valueLength(0),
+  valueSize(0),
+  dataType(type),
+  notifySentMs(0),
+  notifySentCount(0),
+  flushEvent(0),
+  flushAt(0),
+  staged(STAGED_NONE),
+  reportPending(false),
+  postedValue(0),
+  posted(0),
+  fileSink(NULL),
+  fileSinkNextBlock(0),
+  fileSource(NULL),
+  putCallback(NULL),
+  putViewCallback(NULL),
+  postCallback(NULL),
+  notificationCallback(NULL),
+  fileSinkCallback(NULL),
+  internalPostCallback(this, &MbedCloudClientResource::internal_post_callback),
+  internalPutCallback(this, &MbedCloudClientResource::internal_put_callback),
+  internalNotificationCallback(this, &MbedCloudClientResource::internal_notification_callback)
+{
+    nativeValue.intValue = 0;
+    notifyEntry.owner = this;
+    path_to_ids(path, &objectId, &instanceId, &resourceId);
+
+    size_t len = strlen(name);
+    char *copy = new char[len + 1];
+    memcpy(copy, name, len + 1);
+    this->name = copy;
+}
+
+MbedCloudClientResource::MbedCloudClientResource(uint16_t object_id, uint16_t instance_id, uint16_t resource_id,
+                                                 const char *name, M2MResourceInstance::ResourceType type,
+                                                 unsigned int methodMask, bool observable)
+: client(NULL),
+  next(NULL),
+  managed(false),
   resource(NULL),
-  path(path),
+  objectId(object_id),
+  instanceId(instance_id),
+  resourceId(resource_id),
   name(name),
+  ownsName(false),
+  value(NULL),
+  valueLength(0),
+  valueSize(0),
+  dataType(type),
+  isObservable(observable),
+  methodMask(methodMask),
+  notifySentMs(0),
+  notifySentCount(0),
+  flushEvent(0),
+  flushAt(0),
+  staged(STAGED_NONE),
+  reportPending(false),
+  postedValue(0),
+  posted(0),
+  fileSink(NULL),
+  fileSinkNextBlock(0),
+  fileSource(NULL),
   putCallback(NULL),
+  putViewCallback(NULL),
   postCallback(NULL),
   notificationCallback(NULL),
+  fileSinkCallback(NULL),
   internalPostCallback(this, &MbedCloudClientResource::internal_post_callback),
   internalPutCallback(this, &MbedCloudClientResource::internal_put_callback),
   internalNotificationCallback(this, &MbedCloudClientResource::internal_notification_callback)
 {
+    nativeValue.intValue = 0;
+    notifyEntry.owner = this;
+}
+
+MbedCloudClientResource::~MbedCloudClientResource() {
+    if (flushEvent) {
+        mbed_event_queue()->cancel(flushEvent);
+    }
+    if (ownsName) {
+        delete[] name;
+    }
+    free(value);
+    delete fileSink;
+    delete fileSource;
+}
+
+void MbedCloudClientResource::store_value(const uint8_t *buffer, uint32_t length) {
+    if (length + 1 > valueSize) {
+        char *grown = (char*)realloc(value, length + 1);
+        if (!grown) {
+            tr_error("Could not allocate %lu bytes for resource value", (unsigned long)(length + 1));
+            return;
+        }
+        value = grown;
+        valueSize = length + 1;
+    }
+
+    if (length > 0) {
+        memcpy(value, buffer, length);
+    }
+    value[length] = '\0';
+    valueLength = length;
 }
 
 void MbedCloudClientResource::observable(bool observable) {
@@ -79,6 +206,10 @@ void MbedCloudClientResource::attach_put_callback(Callback<void(MbedCloudClientR
     this->putCallback = callback;
 }
 
+void MbedCloudClientResource::attach_put_view_callback(Callback<void(MbedCloudClientResource*, mcc_value_view)> callback) {
+    this->putViewCallback = callback;
+}
+
 void MbedCloudClientResource::attach_post_callback(Callback<void(MbedCloudClientResource*, const uint8_t*, uint16_t)> callback) {
     this->postCallback = callback;
 }
@@ -87,8 +218,75 @@ void MbedCloudClientResource::attach_notification_callback(Callback<void(MbedClo
     this->notificationCallback = callback;
 }
 
+void MbedCloudClientResource::attach_file_sink(const char *path, Callback<void(MbedCloudClientResource*, int, uint32_t, uint32_t)> callback) {
+    delete this->fileSink;
+    this->fileSink = new ResourceFileSink(path);
+    this->fileSinkCallback = callback;
+    this->fileSinkNextBlock = 0;
+
+    if (this->resource) {
+        this->resource->set_incoming_block_message_callback(
+            incoming_block_message_callback(this, &MbedCloudClientResource::internal_block_callback));
+    }
+}
+
+void MbedCloudClientResource::detach_file_sink() {
+    if (this->resource) {
+        this->resource->set_incoming_block_message_callback(incoming_block_message_callback());
+    }
+
+    delete this->fileSink;
+    this->fileSink = NULL;
+    this->fileSinkCallback = NULL;
+}
+
+void MbedCloudClientResource::attach_file_source(const char *path, uint32_t max_read) {
+    delete this->fileSource;
+    this->fileSource = new ResourceFileSource(path, max_read);
+
+    if (this->resource) {
+        register_file_source();
+    }
+}
+
+void MbedCloudClientResource::detach_file_source() {
+    if (this->resource) {
+        this->resource->set_read_resource_function(NULL, NULL);
+        this->resource->set_resource_read_size_function(NULL, NULL);
+    }
+
+    delete this->fileSource;
+    this->fileSource = NULL;
+}
+
+void MbedCloudClientResource::set_file_source_offset(uint32_t offset) {
+    if (this->fileSource) {
+        this->fileSource->set_offset(offset);
+    }
+}
+
+void MbedCloudClientResource::register_file_source() {
+    this->resource->set_read_resource_function(&MbedCloudClientResource::file_source_read_thunk, this);
+    this->resource->set_resource_read_size_function(&MbedCloudClientResource::file_source_size_thunk, this);
+}
+
+int MbedCloudClientResource::file_source_size_thunk(const M2MResourceBase& base, size_t *size, void *client_args) {
+    MbedCloudClientResource *self = static_cast<MbedCloudClientResource*>(client_args);
+    if (!self->fileSource) return -1;
+
+    return self->fileSource->size(self->client ? self->client->get_file_system() : NULL, size);
+}
+
+int MbedCloudClientResource::file_source_read_thunk(const M2MResourceBase& base, void *buffer, size_t *size, void *client_args) {
+    MbedCloudClientResource *self = static_cast<MbedCloudClientResource*>(client_args);
+    if (!self->fileSource) return -1;
+
+    return self->fileSource->read(self->client ? self->client->get_file_system() : NULL, buffer, size);
+}
+
 void MbedCloudClientResource::detach_put_callback() {
     this->putCallback = NULL;
+    this->putViewCallback = NULL;
 }
 
 void MbedCloudClientResource::detach_post_callback() {
@@ -99,41 +297,447 @@ void MbedCloudClientResource::detach_notification_callback() {
     this->notificationCallback = NULL;
 }
 
+M2MResourceInstance::ResourceType MbedCloudClientResource::get_type() {
+    return this->dataType;
+}
+
+bool MbedCloudClientResource::is_integer_type() {
+    return this->dataType == M2MResourceInstance::INTEGER ||
+           this->dataType == M2MResourceInstance::BOOLEAN ||
+           this->dataType == M2MResourceInstance::TIME;
+}
+
+float MbedCloudClientResource::numeric_value() {
+    if (this->dataType == M2MResourceInstance::FLOAT) {
+        return this->nativeValue.floatValue;
+    }
+    return is_integer_type() ? (float)this->nativeValue.intValue : 0.0f;
+}
+
 void MbedCloudClientResource::set_value(int value) {
-    this->value = "";
-    this->value.append_int(value);
+    if (this->dataType == M2MResourceInstance::FLOAT) {
+        set_value((float)value);
+        return;
+    }
 
-    if (this->resource) {
-        this->resource->set_value((uint8_t*)this->value.c_str(), this->value.size());
+    valueMutex.lock();
+
+    if (is_integer_type()) {
+        if (this->dataType == M2MResourceInstance::BOOLEAN) {
+            value = (value != 0);
+        }
+        this->nativeValue.intValue = value;
+    } else {
+        char str[12];
+        int length = sprintf(str, "%d", value);
+        store_value((const uint8_t*)str, length);
     }
+
+    value_updated();
+
+    valueMutex.unlock();
 }
 
 void MbedCloudClientResource::set_value(const char *value) {
-    this->value = value;
+    if (this->dataType == M2MResourceInstance::FLOAT) {
+        set_value((float)atof(value));
+        return;
+    }
 
-    if (this->resource) {
-        this->resource->set_value((uint8_t*)this->value.c_str(), strlen(value));
+    if (is_integer_type()) {
+        set_value(atoi(value));
+        return;
     }
+
+    valueMutex.lock();
+
+    store_value((const uint8_t*)value, strlen(value));
+
+    value_updated();
+
+    valueMutex.unlock();
 }
 
 void MbedCloudClientResource::set_value(float value) {
-    char str[25];
-    int length = sprintf(str, "%g", value);
+    if (is_integer_type()) {
+        set_value((int)value);
+        return;
+    }
 
-    if (this->resource) {
-        this->resource->set_value((uint8_t*)str, length);
+    valueMutex.lock();
+
+    if (this->dataType == M2MResourceInstance::FLOAT) {
+        this->nativeValue.floatValue = value;
+    } else {
+        char str[25];
+        int length = sprintf(str, "%g", value);
+        store_value((const uint8_t*)str, length);
     }
+
+    value_updated();
+
+    valueMutex.unlock();
+}
+
+void MbedCloudClientResource::set_value(bool value) {
+    set_value((int)value);
+}
+
+void MbedCloudClientResource::set_value(const uint8_t *buffer, uint32_t length) {
+    valueMutex.lock();
+
+    store_value(buffer, length);
+
+    value_updated();
+
+    valueMutex.unlock();
 }
 
 m2m::String MbedCloudClientResource::get_value() {
+    valueMutex.lock();
+
+    m2m::String str;
+    if (this->resource && !has_local_value()) {
+        str = this->resource->get_value_string();
+    } else if (this->dataType == M2MResourceInstance::FLOAT) {
+        char buffer[25];
+        sprintf(buffer, "%g", this->nativeValue.floatValue);
+        str = buffer;
+    } else if (is_integer_type()) {
+        char buffer[21];
+        int64_to_string(this->nativeValue.intValue, buffer);
+        str = buffer;
+    } else {
+        str = this->value ? this->value : "";
+    }
+
+    valueMutex.unlock();
+    return str;
+}
+
+bool MbedCloudClientResource::post_value(int value) {
+    // The slot holds 32 bits, a TIME value would be truncated
+    if (!is_integer_type() || this->dataType == M2MResourceInstance::TIME) return false;
+
+    if (this->dataType == M2MResourceInstance::BOOLEAN) {
+        value = (value != 0);
+    }
+    this->postedValue = (uint32_t)value;
+
+    mark_posted();
+    return true;
+}
+
+bool MbedCloudClientResource::post_value(float value) {
+    if (this->dataType != M2MResourceInstance::FLOAT) return false;
+
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    this->postedValue = bits;
+
+    mark_posted();
+    return true;
+}
+
+void MbedCloudClientResource::mark_posted() {
+    // Only the first post since the last drain needs to wake up the client
+    uint8_t expected = 0;
+    if (core_util_atomic_cas_u8(&this->posted, &expected, 1) && this->client) {
+        this->client->value_posted();
+    }
+}
+
+void MbedCloudClientResource::drain_posted() {
+    uint8_t expected = 1;
+    if (!core_util_atomic_cas_u8(&this->posted, &expected, 0)) return;
+
+    // Clear the flag before reading, a post racing with the drain schedules another drain
+    uint32_t bits = this->postedValue;
+
+    valueMutex.lock();
+
+    if (this->dataType == M2MResourceInstance::FLOAT) {
+        memcpy(&this->nativeValue.floatValue, &bits, sizeof(float));
+    } else {
+        this->nativeValue.intValue = (int32_t)bits;
+    }
+
+    // Staged for the drain to publish, a value staged by an open batch stays with that batch
     if (this->resource) {
-        return this->resource->get_value_string();
+        if (this->client && this->client->queue_value(this)) {
+            push_value(this->resource, false);
+        } else if (this->staged == STAGED_NONE) {
+            this->staged = STAGED_POSTED;
+        }
+    }
+
+    valueMutex.unlock();
+}
+
+mcc_value_view MbedCloudClientResource::get_value_view() {
+    mcc_value_view view;
+
+    if (this->resource && !has_local_value()) {
+        view.data = this->resource->value();
+        view.length = this->resource->value_length();
+    } else if (!is_integer_type() && this->dataType != M2MResourceInstance::FLOAT) {
+        view.data = (const uint8_t*)this->value;
+        view.length = this->valueLength;
+    } else {
+        view.data = NULL;
+        view.length = 0;
+    }
+
+    return view;
+}
+
+void MbedCloudClientResource::notification_policy(uint32_t min_interval_ms, uint32_t max_interval_ms, float threshold) {
+    valueMutex.lock();
+    this->coalescer.configure(min_interval_ms, max_interval_ms, threshold);
+    valueMutex.unlock();
+}
+
+bool MbedCloudClientResource::priority(mcc_priority priority) {
+    if (this->client) {
+        return this->client->set_notification_priority(this, priority);
+    }
+
+    // Not added to a client, so never scheduled
+    this->notifyEntry.priority = priority;
+    return true;
+}
+
+mcc_priority MbedCloudClientResource::get_priority() {
+    return (mcc_priority)this->notifyEntry.priority;
+}
+
+uint32_t MbedCloudClientResource::get_suppressed_count() {
+    return this->coalescer.suppressed();
+}
+
+void MbedCloudClientResource::value_updated() {
+    if (!this->resource) return;
+
+    // While offline, or while older queued values are being sent, the value goes into the queue
+    if (this->client && this->client->queue_value(this)) {
+        push_value(this->resource, false);
+        return;
+    }
+
+    if (this->client && this->client->is_batch_active()) {
+        this->staged = STAGED_BATCH;
+        return;
+    }
+
+    if (this->coalescer.enabled() &&
+        !this->coalescer.on_write(numeric_value(), is_integer_type() || this->dataType == M2MResourceInstance::FLOAT,
+                                  Kernel::get_ms_count())) {
+        if (this->coalescer.has_pending()) {
+            schedule_flush(this->coalescer.deadline_ms());
+        }
+        return;
+    }
+
+    notify();
+}
+
+bool MbedCloudClientResource::has_local_value() {
+    // A held back, staged or queued value is newer than what Mbed Cloud Client has
+    return this->staged != STAGED_NONE || this->coalescer.has_pending() || this->notifyEntry.queued;
+}
+
+void MbedCloudClientResource::notify() {
+    if (this->client && this->client->schedule_notification(this)) return;
+
+    publish();
+}
+
+void MbedCloudClientResource::publish(bool report) {
+    valueMutex.lock();
+
+    this->staged = STAGED_NONE;
+    if (report) {
+        this->notifySentMs = (uint32_t)Kernel::get_ms_count();
+        this->notifySentCount = 0;
+    }
+    push_value(this->resource, report);
+    this->coalescer.on_published(numeric_value(), Kernel::get_ms_count());
+
+    valueMutex.unlock();
+}
+
+void MbedCloudClientResource::store_dropped() {
+    valueMutex.lock();
+
+    // Queued again since it was dropped, the scheduler sends the newer value
+    if (this->resource && !this->notifyEntry.queued) {
+        publish(false);
+    }
+
+    valueMutex.unlock();
+}
+
+void MbedCloudClientResource::send_scheduled() {
+    valueMutex.lock();
+
+    // set_value() only notifies when the value changed and passes the gt/lt/st attributes,
+    // so the scheduler could wait forever for the delivery status. Force the notification,
+    // as for a batch.
+    publish(false);
+    report_stored(true);
+
+    valueMutex.unlock();
+}
+
+void MbedCloudClientResource::push_value(M2MResource *res, bool report) {
+    if (!report) {
+        // set_value_raw() stores the text representation without sending a notification
+        char str[25];
+        if (this->dataType == M2MResourceInstance::FLOAT) {
+            int length = sprintf(str, "%g", this->nativeValue.floatValue);
+            set_value_raw_copy(res, str, length);
+        } else if (is_integer_type()) {
+            int length = int64_to_string(this->nativeValue.intValue, str);
+            set_value_raw_copy(res, str, length);
+        } else if (this->value) {
+            set_value_raw_copy(res, this->value, this->valueLength);
+        }
+        return;
+    }
+
+    if (this->dataType == M2MResourceInstance::FLOAT) {
+        res->set_value_float(this->nativeValue.floatValue);
+    } else if (is_integer_type()) {
+        res->set_value(this->nativeValue.intValue);
+    } else if (this->value) {
+        res->set_value((const uint8_t*)this->value, this->valueLength);
+    }
+}
+
+bool MbedCloudClientResource::store_staged(uint8_t tag) {
+    valueMutex.lock();
+
+    bool stored = this->staged == tag;
+    if (stored) {
+        publish(false);
+        this->reportPending = true;
+    }
+
+    valueMutex.unlock();
+    return stored;
+}
+
+bool MbedCloudClientResource::report_stored(bool notify_instance) {
+    valueMutex.lock();
+
+    M2MBase::Observation level = this->resource->observation_level();
+    bool instance_observed = (level & (M2MBase::O_Attribute | M2MBase::OI_Attribute)) != 0;
+    bool resource_observed = (level & M2MBase::R_Attribute) != 0;
+
+    if (resource_observed || (notify_instance && instance_observed)) {
+        this->notifySentMs = (uint32_t)Kernel::get_ms_count();
+        this->notifySentCount = 0;
+    }
+    if (notify_instance && instance_observed) {
+        this->resource->get_parent_object_instance().notification_update(level);
+    }
+    if (resource_observed) {
+        M2MReportHandler *handler = this->resource->report_handler();
+        if (handler) {
+            handler->set_notification_trigger();
+        }
+    }
+
+    valueMutex.unlock();
+    return instance_observed;
+}
+
+bool MbedCloudClientResource::fill_queued_record(mcc_queued_record *record) {
+    record->object_id = this->objectId;
+    record->instance_id = this->instanceId;
+    record->resource_id = this->resourceId;
+    record->reserved = 0;
+    record->timestamp = (uint32_t)time(NULL);
+
+    if (this->dataType == M2MResourceInstance::FLOAT) {
+        memcpy(record->value, &this->nativeValue.floatValue, sizeof(float));
+        record->length = sizeof(float);
+    } else if (is_integer_type()) {
+        memcpy(record->value, &this->nativeValue.intValue, sizeof(int64_t));
+        record->length = sizeof(int64_t);
     } else {
-        return this->value;
+        if (this->valueLength > sizeof(record->value)) return false;
+        if (this->valueLength > 0) {
+            memcpy(record->value, this->value, this->valueLength);
+        }
+        record->length = this->valueLength;
     }
+    return true;
+}
+
+void MbedCloudClientResource::apply_queued_record(const mcc_queued_record *record) {
+    uint32_t expected = this->dataType == M2MResourceInstance::FLOAT ? sizeof(float) :
+                        is_integer_type() ? sizeof(int64_t) : record->length;
+    if (record->length != expected) return;
+
+    valueMutex.lock();
+
+    if (this->dataType == M2MResourceInstance::FLOAT) {
+        memcpy(&this->nativeValue.floatValue, record->value, sizeof(float));
+    } else if (is_integer_type()) {
+        memcpy(&this->nativeValue.intValue, record->value, sizeof(int64_t));
+    } else {
+        store_value(record->value, record->length);
+    }
+
+    if (this->resource) {
+        publish();
+    }
+
+    valueMutex.unlock();
+}
+
+void MbedCloudClientResource::schedule_flush(uint64_t deadline_ms) {
+    if (this->flushEvent) {
+        if (this->flushAt <= deadline_ms) return;
+        mbed_event_queue()->cancel(this->flushEvent);
+    }
+
+    uint64_t now = Kernel::get_ms_count();
+    int delay = deadline_ms > now ? (int)(deadline_ms - now) : 0;
+
+    this->flushAt = deadline_ms;
+    this->flushEvent = mbed_event_queue()->call_in(delay, callback(this, &MbedCloudClientResource::flush_pending));
+    if (!this->flushEvent) {
+        // Nothing would publish the held back value, so do not hold it back
+        tr_warn("Could not schedule the held back value of %u/%u/%u", this->objectId, this->instanceId, this->resourceId);
+        notify();
+    }
+}
+
+void MbedCloudClientResource::flush_pending() {
+    valueMutex.lock();
+
+    this->flushEvent = 0;
+
+    if (this->coalescer.has_pending()) {
+        if (Kernel::get_ms_count() < this->coalescer.deadline_ms()) {
+            schedule_flush(this->coalescer.deadline_ms());
+        } else {
+            notify();
+        }
+    }
+
+    valueMutex.unlock();
 }
 
 void MbedCloudClientResource::internal_post_callback(void *params) {
+    if (fileSink && params) {
+        M2MResource::M2MExecuteParameter* parameters = static_cast<M2MResource::M2MExecuteParameter*>(params);
+        sink_payload(parameters->get_argument_value(), parameters->get_argument_value_length());
+        return;
+    }
+
     if (!postCallback) return;
 
     if (params) { // data can be NULL!
@@ -148,17 +752,104 @@ void MbedCloudClientResource::internal_post_callback(void *params) {
 }
 
 void MbedCloudClientResource::internal_put_callback(const char* resource) {
-    if (!putCallback) return;
+    // On a file source, a PUT moves the window that is served
+    if (fileSource) {
+        mcc_value_view view = this->get_value_view();
+        char offset[11];
+        uint32_t length = view.length < sizeof(offset) - 1 ? view.length : sizeof(offset) - 1;
+        if (length) {
+            memcpy(offset, view.data, length);
+        }
+        offset[length] = '\0';
+        fileSource->set_offset(strtoul(offset, NULL, 10));
+        return;
+    }
+
+    // Payloads that fit in a single message do not go through internal_block_callback
+    if (fileSink) {
+        mcc_value_view view = this->get_value_view();
+        sink_payload(view.data, view.length);
+        return;
+    }
+
+    if (putViewCallback) {
+        putViewCallback(this, this->get_value_view());
+    }
 
-    putCallback(this, this->get_value());
+    // Only copy the value when the application asked for a string
+    if (putCallback) {
+        putCallback(this, this->get_value());
+    }
 }
 
 void MbedCloudClientResource::internal_notification_callback(const M2MBase& m2mbase, const NoticationDeliveryStatus status) {
+    if (client) {
+        client->notification_status(this, status);
+    }
+
     if (!notificationCallback) return;
 
     notificationCallback(this, status);
 }
 
+void MbedCloudClientResource::internal_block_callback(M2MBlockMessage *message) {
+    if (!fileSink || !message) return;
+
+    if (message->error_code() != M2MBlockMessage::ErrorNone) {
+        tr_error("Block transfer on %u/%u/%u failed (%d)", objectId, instanceId, resourceId, message->error_code());
+        fileSink->abort();
+        sink_complete(-1);
+        return;
+    }
+
+    if (message->block_number() == 0) {
+        int status = fileSink->begin(this->client ? this->client->get_file_system() : NULL);
+        if (status != 0) {
+            sink_complete(status);
+            return;
+        }
+        fileSinkNextBlock = 0;
+    }
+
+    // Blocks of a failed transfer, or blocks out of order, are dropped
+    if (!fileSink->is_open()) return;
+
+    if (message->block_number() != fileSinkNextBlock) {
+        tr_error("Unexpected block %lu, expected %lu", (unsigned long)message->block_number(), (unsigned long)fileSinkNextBlock);
+        fileSink->abort();
+        sink_complete(-1);
+        return;
+    }
+    fileSinkNextBlock++;
+
+    int status = fileSink->write(message->block_data(), message->block_data_len());
+    if (status != 0) {
+        sink_complete(status);
+        return;
+    }
+
+    if (message->is_last_block()) {
+        sink_complete(fileSink->finish());
+    }
+}
+
+void MbedCloudClientResource::sink_payload(const uint8_t *buffer, uint32_t length) {
+    int status = fileSink->begin(this->client ? this->client->get_file_system() : NULL);
+    if (status == 0 && length > 0) {
+        status = fileSink->write(buffer, length);
+    }
+    if (status == 0) {
+        status = fileSink->finish();
+    }
+    sink_complete(status);
+}
+
+void MbedCloudClientResource::sink_complete(int status) {
+    if (fileSinkCallback) {
+        fileSinkCallback(this, status, fileSink->size(), status == 0 ? fileSink->checksum() : 0);
+    }
+}
+
 const char * MbedCloudClientResource::delivery_status_to_string(const NoticationDeliveryStatus status) {
     switch(status) {
         case NOTIFICATION_STATUS_INIT: return "Init";
@@ -178,11 +869,15 @@ M2MResource *MbedCloudClientResource::get_m2m_resource() {
 }
 
 void MbedCloudClientResource::get_data(mcc_resource_def *resourceDef) {
-    path_to_ids(this->path.c_str(), &(resourceDef->object_id), &(resourceDef->instance_id), &(resourceDef->resource_id));
+    resourceDef->object_id = this->objectId;
+    resourceDef->instance_id = this->instanceId;
+    resourceDef->resource_id = this->resourceId;
     resourceDef->name = this->name;
+    resourceDef->data_type = this->dataType;
     resourceDef->method_mask = this->methodMask;
     resourceDef->observable = this->isObservable;
-    resourceDef->value = this->get_value();
+    // Typed values are applied natively in set_m2m_resource, only strings go through the definition
+    resourceDef->value = (this->dataType == M2MResourceInstance::STRING) ? this->get_value() : m2m::String("");
     resourceDef->put_callback = &(this->internalPutCallback);
     resourceDef->post_callback = &(this->internalPostCallback);
     resourceDef->notification_callback = &(this->internalNotificationCallback);
@@ -190,16 +885,70 @@ void MbedCloudClientResource::get_data(mcc_resource_def *resourceDef) {
 
 void MbedCloudClientResource::set_m2m_resource(M2MResource *res) {
     this->resource = res;
+
+    if (!res) return;
+
+    // Push the value that was set before registration in its native representation,
+    // string values were already passed to add_resource
+    if (this->dataType != M2MResourceInstance::STRING) {
+        push_value(res);
+    }
+
+    if (this->fileSource) {
+        register_file_source();
+    }
+
+    if (this->fileSink) {
+        res->set_incoming_block_message_callback(
+            incoming_block_message_callback(this, &MbedCloudClientResource::internal_block_callback));
+    }
 }
 
 int MbedCloudClientResource::get_value_int() {
-    if (!this->resource) return 0;
+    return (int)get_value_int64();
+}
+
+int64_t MbedCloudClientResource::get_value_int64() {
+    if (this->dataType == M2MResourceInstance::FLOAT) {
+        return (int64_t)get_value_float();
+    }
+
+    if (!is_integer_type()) {
+        if (!this->resource) return 0;
+
+        return strtoll(this->get_value().c_str(), NULL, 10);
+    }
+
+    valueMutex.lock();
+
+    // A held back, staged or queued value is newer than what Mbed Cloud Client has
+    int64_t value;
+    if (!this->resource || has_local_value()) {
+        value = this->nativeValue.intValue;
+    } else {
+        value = this->resource->get_value_int();
+    }
 
-    return this->resource->get_value_int();
+    valueMutex.unlock();
+    return value;
 }
 
 float MbedCloudClientResource::get_value_float() {
-    if (!this->resource) return 0.0f;
+    if (this->dataType != M2MResourceInstance::FLOAT) {
+        if (!this->resource) return 0.0f;
+
+        return atof(this->get_value().c_str());
+    }
+
+    valueMutex.lock();
+
+    float value;
+    if (!this->resource || has_local_value()) {
+        value = this->nativeValue.floatValue;
+    } else {
+        value = this->resource->get_value_float();
+    }
 
-    return atof(this->get_value().c_str());
+    valueMutex.unlock();
+    return value;
 }
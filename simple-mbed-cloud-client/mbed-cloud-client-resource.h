@@ -22,6 +22,10 @@
 #include "mbed.h"
 #include "simple-mbed-cloud-client.h"
 #include "mbed-client/m2mstring.h"
+#include "notification-coalescer.h"
+#include "resource-stream.h"
+#include "notification-queue.h"
+#include "notification-scheduler.h"
 
 namespace M2MMethod {
 
@@ -39,6 +43,7 @@ struct mcc_resource_def {
     unsigned int instance_id;
     unsigned int resource_id;
     String name;
+    M2MResourceInstance::ResourceType data_type;
     unsigned int method_mask;
     String value;
     bool observable;
@@ -47,9 +52,40 @@ struct mcc_resource_def {
     Callback<void(const M2MBase&, const NoticationDeliveryStatus)> *notification_callback;
 };
 
+/**
+ * Tag type for a TIME resource in MbedCloudClientStaticResource, the value is
+ * set as an integer (seconds since the epoch).
+ */
+struct mcc_time;
+
+/**
+ * Maps a C++ value type to the LwM2M data type of a resource,
+ * used by MbedCloudClientStaticResource.
+ */
+template <typename T> struct mcc_resource_type;
+template <> struct mcc_resource_type<int>         { static const M2MResourceInstance::ResourceType value = M2MResourceInstance::INTEGER; };
+template <> struct mcc_resource_type<float>       { static const M2MResourceInstance::ResourceType value = M2MResourceInstance::FLOAT; };
+template <> struct mcc_resource_type<bool>        { static const M2MResourceInstance::ResourceType value = M2MResourceInstance::BOOLEAN; };
+template <> struct mcc_resource_type<const char*> { static const M2MResourceInstance::ResourceType value = M2MResourceInstance::STRING; };
+template <> struct mcc_resource_type<uint8_t*>    { static const M2MResourceInstance::ResourceType value = M2MResourceInstance::OPAQUE; };
+template <> struct mcc_resource_type<int64_t>     { static const M2MResourceInstance::ResourceType value = M2MResourceInstance::INTEGER; };
+template <> struct mcc_resource_type<mcc_time>    { static const M2MResourceInstance::ResourceType value = M2MResourceInstance::TIME; };
+
+/**
+ * Read-only view of a resource value, does not own or copy the data.
+ * The view is valid until the value of the resource changes.
+ */
+struct mcc_value_view {
+    const uint8_t *data;
+    uint32_t length;
+};
+
 class SimpleMbedCloudClient;
 
 class MbedCloudClientResource {
+    friend class SimpleMbedCloudClient;
+    friend class MbedCloudClientTimeSeries;
+
     public:
         /**
          * Create a new resource, this function should not be called directly!
@@ -59,8 +95,32 @@ class MbedCloudClientResource {
          * @param client Instance of SimpleMbedCloudClient
          * @param path LwM2M path (in the form of 3200/0/5501)
          * @param name Name of the resource (will be shown in the UI)
+         * @param type Data type of the resource value, defaults to STRING
+         */
+        MbedCloudClientResource(SimpleMbedCloudClient *client, const char *path, const char *name,
+                                M2MResourceInstance::ResourceType type = M2MResourceInstance::STRING);
+
+        /**
+         * Create a resource that does not allocate any memory.
+         * The name is not copied and must outlive the resource (e.g. a string literal).
+         * Add the resource with 'add_resource' on the SimpleMbedCloudClient object.
+         *
+         * @param object_id LwM2M object ID
+         * @param instance_id LwM2M object instance ID
+         * @param resource_id LwM2M resource ID
+         * @param name Name of the resource (will be shown in the UI)
+         * @param type Data type of the resource value
+         * @param methodMask Mask of objects of type M2MMethod
+         * @param observable Whether Pelion Device Management can subscribe for updates
+         */
+        MbedCloudClientResource(uint16_t object_id, uint16_t instance_id, uint16_t resource_id,
+                                const char *name, M2MResourceInstance::ResourceType type,
+                                unsigned int methodMask, bool observable);
+
+        /**
+         * MbedCloudClientResource destructor
          */
-        MbedCloudClientResource(SimpleMbedCloudClient *client, const char *path, const char *name);
+        ~MbedCloudClientResource();
 
         /**
          * Sets whether the resource can be observed
@@ -85,6 +145,15 @@ class MbedCloudClientResource {
          */
         void attach_put_callback(Callback<void(MbedCloudClientResource*, m2m::String)> callback);
 
+        /**
+         * Set a callback when a PUT action on this resource happens
+         * Receives a view on the buffer of the underlying M2MResource, so the
+         * value is not copied. Copy the data if it is needed after the callback returns.
+         *
+         * @params callback
+         */
+        void attach_put_view_callback(Callback<void(MbedCloudClientResource*, mcc_value_view)> callback);
+
         /**
          * Set a callback when a POST action on this resource happens
          * Fires whenever someone executes the resource from Pelion Device Management
@@ -103,7 +172,55 @@ class MbedCloudClientResource {
         void attach_notification_callback(Callback<void(MbedCloudClientResource*, const NoticationDeliveryStatus)> callback);
 
         /**
-         * Clear the PUT callback
+         * Stream PUT payloads on this resource to a file, as they arrive.
+         * Each CoAP block of a PUT is written to the file system managed by SimpleMbedCloudClient
+         * and is not kept in RAM, so the payload can be larger than the available memory.
+         * POST payloads are written to the file as well, but Mbed Cloud Client reassembles
+         * them in RAM first, so they are limited by the available memory.
+         * The file is truncated when a new payload starts, and removed if the transfer fails.
+         *
+         * The PUT and POST callbacks are not called for payloads streamed to the file.
+         *
+         * @param path Path of the file, relative to the file system (e.g. "config.bin"), copied
+         * @param callback Called when the payload is complete or failed, with status (0 on success),
+         *                 total size in bytes and CRC-32 of the payload
+         */
+        void attach_file_sink(const char *path, Callback<void(MbedCloudClientResource*, int, uint32_t, uint32_t)> callback);
+
+        /**
+         * Stop streaming payloads to a file
+         */
+        void detach_file_sink();
+
+        /**
+         * Serve GET requests on this resource from a file, e.g. a log or crash dump.
+         * The file is read from the file system managed by SimpleMbedCloudClient on every request,
+         * and its contents are never held by this object.
+         *
+         * A request returns at most max_read bytes starting at the current offset,
+         * which keeps memory bounded regardless of the file size. The offset is moved
+         * with 'set_file_source_offset', or from Pelion Device Management by a PUT of the
+         * offset as an integer (requires M2MMethod::PUT).
+         *
+         * @param path Path of the file, relative to the file system (e.g. "log.txt"), copied
+         * @param max_read Maximum number of bytes returned per GET
+         */
+        void attach_file_source(const char *path, uint32_t max_read = 1024);
+
+        /**
+         * Stop serving GET requests from a file
+         */
+        void detach_file_source();
+
+        /**
+         * Move the window of the file served by 'attach_file_source'
+         *
+         * @param offset Offset in bytes from the start of the file
+         */
+        void set_file_source_offset(uint32_t offset);
+
+        /**
+         * Clear the PUT callbacks
          */
         void detach_put_callback();
 
@@ -117,9 +234,17 @@ class MbedCloudClientResource {
          */
         void detach_notification_callback();
 
+        /**
+         * Get the data type of the resource value
+         *
+         * @returns Type the resource was created with
+         */
+        M2MResourceInstance::ResourceType get_type();
+
         /**
          * Set the value of the resource to an integer.
-         * Underneath all values in Pelion Device Management are strings, so this will serialize the value
+         * On INTEGER, BOOLEAN and TIME resources the value is stored natively,
+         * on STRING resources this will serialize the value
          *
          * @param value New value
          */
@@ -127,6 +252,7 @@ class MbedCloudClientResource {
 
         /**
          * Set the value of the resource to a string.
+         * On typed resources the string is parsed into the native value
          *
          * @param value New value
          */
@@ -134,12 +260,93 @@ class MbedCloudClientResource {
 
         /**
          * Set the value of the resource to a float.
-         * Underneath all values in Pelion Device Management are strings, so this will serialize the value
+         * On FLOAT resources the value is stored natively,
+         * on STRING resources this will serialize the value
          *
          * @param value New value
          */
         void set_value(float value);
 
+        /**
+         * Set the value of the resource to a boolean.
+         *
+         * @param value New value
+         */
+        void set_value(bool value);
+
+        /**
+         * Set the value of the resource to a raw buffer, for OPAQUE resources.
+         *
+         * @param buffer New value
+         * @param length Length of the buffer
+         */
+        void set_value(const uint8_t *buffer, uint32_t length);
+
+        /**
+         * Set the value of an INTEGER or BOOLEAN resource from any context, including interrupts.
+         *
+         * The value is stored in a lock-free 32-bit slot on the resource, without locking or allocating.
+         * The slots are drained in one pass on the shared event queue, which publishes the latest
+         * posted value of each resource. Only the last value posted before the drain is published.
+         * TIME resources are rejected, as their values do not fit in the slot; use 'set_value' for them.
+         * Use 'post_value(float)' for FLOAT resources.
+         *
+         * @param value New value
+         *
+         * @returns true if the value was posted, false if the resource is not INTEGER or BOOLEAN
+         */
+        bool post_value(int value);
+
+        /**
+         * Set the value of a FLOAT resource from any context, including interrupts.
+         * See 'post_value(int)'. Use 'post_value(int)' for INTEGER and BOOLEAN resources;
+         * TIME resources are rejected.
+         *
+         * @param value New value
+         *
+         * @returns true if the value was posted, false if the resource is not FLOAT
+         */
+        bool post_value(float value);
+
+        /**
+         * Limit how often writes to this resource are published to Pelion Device Management.
+         * Only the latest value is kept while a write is held back, and held back
+         * values are published from the shared event queue when their window expires.
+         *
+         * @param min_interval_ms Minimum time between two published values, 0 for no limit
+         * @param max_interval_ms Maximum time a value within the threshold is held back,
+         *                        0 to drop such values
+         * @param threshold Minimum change of an INTEGER or FLOAT value to publish it (dead-band),
+         *                  0 to publish every change
+         */
+        void notification_policy(uint32_t min_interval_ms, uint32_t max_interval_ms = 0, float threshold = 0.0f);
+
+        /**
+         * Get the number of writes that were never published because of the notification policy
+         *
+         * @returns Number of suppressed writes
+         */
+        uint32_t get_suppressed_count();
+
+        /**
+         * Set the priority class of the notifications of this resource.
+         *
+         * When SimpleMbedCloudClient limits the notifications in flight
+         * (see 'SimpleMbedCloudClient::notification_limits'), high priority notifications
+         * are sent first and never dropped, low priority notifications are dropped first.
+         * The priority cannot change while a notification of this resource is queued or in flight.
+         *
+         * @param priority MCC_PRIORITY_HIGH, MCC_PRIORITY_NORMAL (default) or MCC_PRIORITY_LOW
+         *
+         * @returns true if the priority was changed, false if a notification is queued or in flight
+         */
+        bool priority(mcc_priority priority);
+
+        /**
+         * Get the priority class of the notifications of this resource
+         */
+        mcc_priority get_priority();
+
         /**
          * Get the value of the resource as a string
          *
@@ -147,17 +354,37 @@ class MbedCloudClientResource {
          */
         m2m::String get_value();
 
+        /**
+         * Get the value of the resource without copying it
+         * For a registered resource this points into the buffer of the M2MResource,
+         * otherwise into the STRING or OPAQUE value held by this object.
+         * Unregistered INTEGER, BOOLEAN, TIME and FLOAT values have no text
+         * representation, use 'get_value_int' or 'get_value_float' for these.
+         *
+         * @returns View on the current value, valid until the value changes
+         */
+        mcc_value_view get_value_view();
+
         /**
          * Get the value of the resource as an integer
-         * Underneath all values in Pelion Device Management are strings, so this will de-serialize the value
+         * On STRING resources this will de-serialize the value
+         * Values outside the range of int are truncated, use 'get_value_int64' for TIME resources.
          *
          * @returns Current value
          */
         int get_value_int();
 
+        /**
+         * Get the value of the resource as a 64-bit integer, e.g. of a TIME resource
+         * On STRING resources this will de-serialize the value
+         *
+         * @returns Current value
+         */
+        int64_t get_value_int64();
+
         /**
          * Get the value of the resource as a float
-         * Underneath all values in Pelion Device Management are strings, so this will de-serialize the value
+         * On STRING resources this will de-serialize the value
          *
          * @returns Current value
          */
@@ -192,24 +419,116 @@ class MbedCloudClientResource {
         static const char * delivery_status_to_string(const NoticationDeliveryStatus status);
 
     private:
+        // What staged a value that is not published yet
+        enum {
+            STAGED_NONE = 0,
+            STAGED_BATCH,   // SimpleMbedCloudClient::begin_batch() on the thread that set it
+            STAGED_POSTED   // SimpleMbedCloudClient::drain_posted_values()
+        };
+
+        // Not copyable, the resource owns its name and value buffers
+        MbedCloudClientResource(const MbedCloudClientResource&);
+        MbedCloudClientResource& operator=(const MbedCloudClientResource&);
+
         void internal_post_callback(void* params);
         void internal_put_callback(const char* resource);
         void internal_notification_callback(const M2MBase& m2mbase, const NoticationDeliveryStatus status);
+        bool is_integer_type();
+        float numeric_value();
+        void store_value(const uint8_t *buffer, uint32_t length);
+        void value_updated();
+        void publish(bool report = true);
+        void store_dropped();
+        void send_scheduled();
+        bool store_staged(uint8_t tag);
+        bool report_stored(bool notify_instance);
+        void push_value(M2MResource *res, bool report = true);
+        void schedule_flush(uint64_t deadline_ms);
+        void flush_pending();
+        void mark_posted();
+        void drain_posted();
+        void internal_block_callback(M2MBlockMessage *message);
+        void sink_payload(const uint8_t *buffer, uint32_t length);
+        void sink_complete(int status);
+        void register_file_source();
+        bool has_local_value();
+        void notify();
+        bool fill_queued_record(mcc_queued_record *record);
+        void apply_queued_record(const mcc_queued_record *record);
+        static int file_source_size_thunk(const M2MResourceBase& base, size_t *size, void *client_args);
+        static int file_source_read_thunk(const M2MResourceBase& base, void *buffer, size_t *size, void *client_args);
 
         SimpleMbedCloudClient *client;
+        MbedCloudClientResource *next;
+        // Guards the value and the notification state, values are set by the application
+        // and published from the event queue
+        Mutex valueMutex;
+        bool managed;
         M2MResource *resource;
-        m2m::String path;
-        m2m::String name;
-        m2m::String value;
+        uint16_t objectId;
+        uint16_t instanceId;
+        uint16_t resourceId;
+        const char *name;
+        bool ownsName;
+        // Only STRING and OPAQUE values are kept here, allocated on first use
+        char *value;
+        uint32_t valueLength;
+        uint32_t valueSize;
+        M2MResourceInstance::ResourceType dataType;
+        union {
+            int64_t intValue;
+            float floatValue;
+        } nativeValue;
         bool isObservable;
         unsigned int methodMask;
+        NotificationCoalescer coalescer;
+        NotificationScheduler::Entry notifyEntry;
+        // Time the last notification was sent, and how often it was reported as sent
+        uint32_t notifySentMs;
+        uint8_t notifySentCount;
+        int flushEvent;
+        uint64_t flushAt;
+        // One of STAGED_*, set while the value waits to be published with others
+        uint8_t staged;
+        // Set while commit() has stored the value and not sent its notification yet
+        bool reportPending;
+        // Slot written by post_value(), a single word so any context can store it atomically
+        volatile uint32_t postedValue;
+        volatile uint8_t posted;
+        ResourceFileSink *fileSink;
+        uint32_t fileSinkNextBlock;
+        ResourceFileSource *fileSource;
 
         Callback<void(MbedCloudClientResource*, m2m::String)> putCallback;
+        Callback<void(MbedCloudClientResource*, mcc_value_view)> putViewCallback;
         Callback<void(MbedCloudClientResource*, const uint8_t*, uint16_t)> postCallback;
         Callback<void(MbedCloudClientResource*, const NoticationDeliveryStatus)> notificationCallback;
+        Callback<void(MbedCloudClientResource*, int, uint32_t, uint32_t)> fileSinkCallback;
         Callback<void(void*)> internalPostCallback;
         Callback<void(const char*)> internalPutCallback;
         Callback<void(const M2MBase&, const NoticationDeliveryStatus)> internalNotificationCallback;
 };
 
+/**
+ * A resource whose LwM2M path and data type are fixed at compile time,
+ * e.g. 'MbedCloudClientStaticResource<3303, 0, 5700, float> temperature("temperature", M2MMethod::GET, true);'
+ *
+ * Declare these as globals or members and add them with 'add_resource',
+ * registration then does not allocate beyond what Mbed Cloud Client needs.
+ */
+template <uint16_t ObjectId, uint16_t InstanceId, uint16_t ResourceId, typename T>
+class MbedCloudClientStaticResource : public MbedCloudClientResource {
+    public:
+        /**
+         * @param name Name of the resource (will be shown in the UI), not copied
+         * @param methodMask Mask of objects of type M2MMethod
+         * @param observable Whether Pelion Device Management can subscribe for updates
+         */
+        MbedCloudClientStaticResource(const char *name, unsigned int methodMask, bool observable = false)
+        : MbedCloudClientResource(ObjectId, InstanceId, ResourceId, name,
+                                  mcc_resource_type<T>::value, methodMask, observable)
+        {
+        }
+};
+
 #endif // MBED_CLOUD_CLIENT_RESOURCE_H
@@ -0,0 +1,157 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "mbed-cloud-client-timeseries.h"
+#include "mbed_trace.h"
+#include <string.h>
+#include <time.h>
+
+#define TRACE_GROUP "SMCT"
+
+// Worst case encoded size of one record, and of the extra fields of the first one
+#define SENML_CBOR_RECORD_SIZE  13
+#define SENML_JSON_RECORD_SIZE  40
+#define SENML_HEADER_SIZE       32
+
+// Below this the RTC has not been set, SenML treats such times as relative
+#define SENML_RELATIVE_TIME_LIMIT 268435456
+
+MbedCloudClientTimeSeries::MbedCloudClientTimeSeries(MbedCloudClientResource *resource, uint32_t capacity, uint32_t period_ms,
+                                                     SenmlWriter::Format format, const char *base_name)
+    : _resource(resource),
+      _format(format),
+      _base_name(base_name),
+      _capacity(capacity),
+      _head(0),
+      _count(0),
+      _dropped(0),
+      _period_event(0)
+{
+    if (resource->get_type() != M2MResourceInstance::OPAQUE) {
+        tr_error("Time series need an OPAQUE resource, samples will not be written");
+        _resource = NULL;
+    }
+
+    _samples = new sample[capacity];
+
+    _payload_size = SENML_HEADER_SIZE + (base_name ? strlen(base_name) : 0) +
+        capacity * (format == SenmlWriter::CBOR ? SENML_CBOR_RECORD_SIZE : SENML_JSON_RECORD_SIZE);
+    _payload = new uint8_t[_payload_size];
+
+    if (period_ms > 0) {
+        _period_event = mbed_event_queue()->call_every(period_ms, callback(this, &MbedCloudClientTimeSeries::period_expired));
+    }
+}
+
+MbedCloudClientTimeSeries::~MbedCloudClientTimeSeries() {
+    if (_period_event) {
+        mbed_event_queue()->cancel(_period_event);
+    }
+    delete[] _samples;
+    delete[] _payload;
+}
+
+void MbedCloudClientTimeSeries::add_sample(float value) {
+    _mutex.lock();
+
+    if (_count == _capacity && is_registered()) {
+        _mutex.unlock();
+        flush();
+        _mutex.lock();
+    }
+
+    if (_count == _capacity) {
+        // Still full, keep the newest samples
+        _head = (_head + 1) % _capacity;
+        _count--;
+        _dropped++;
+    }
+
+    sample *s = &_samples[(_head + _count) % _capacity];
+    s->time_ms = Kernel::get_ms_count();
+    s->value = value;
+    _count++;
+
+    _mutex.unlock();
+}
+
+int MbedCloudClientTimeSeries::flush() {
+    if (!_resource) return -1;
+
+    // Packs written while unregistered would overwrite each other, the ring buffer keeps the samples instead
+    if (!is_registered()) return 0;
+
+    _mutex.lock();
+
+    if (_count == 0) {
+        _mutex.unlock();
+        return 0;
+    }
+
+    uint64_t now_ms = Kernel::get_ms_count();
+    time_t now = time(NULL);
+    int64_t base_time = now >= SENML_RELATIVE_TIME_LIMIT ? (int64_t)now : 0;
+
+    SenmlWriter writer(_format, _payload, _payload_size);
+    writer.begin(_count);
+    for (uint32_t i = 0; i < _count; i++) {
+        const sample &s = _samples[(_head + i) % _capacity];
+        float t = -(float)(now_ms - s.time_ms) / 1000.0f;
+        if (i == 0) {
+            writer.add(_base_name, base_time, t, s.value);
+        } else {
+            writer.add(NULL, 0, t, s.value);
+        }
+    }
+    size_t length = writer.end();
+
+    int written = _count;
+    _head = 0;
+    _count = 0;
+
+    if (length == 0) {
+        tr_error("SenML pack of %d samples does not fit in %lu bytes", written, (unsigned long)_payload_size);
+        _mutex.unlock();
+        return -1;
+    }
+
+    // The payload buffer is reused, so it is handed over while still holding the lock
+    tr_debug("Flushing %d samples in %lu bytes", written, (unsigned long)length);
+    _resource->set_value(_payload, length);
+
+    _mutex.unlock();
+
+    return written;
+}
+
+uint32_t MbedCloudClientTimeSeries::get_count() {
+    return _count;
+}
+
+uint32_t MbedCloudClientTimeSeries::get_dropped_count() {
+    return _dropped;
+}
+
+bool MbedCloudClientTimeSeries::is_registered() {
+    return _resource && _resource->get_m2m_resource() != NULL &&
+           _resource->client && _resource->client->is_client_registered();
+}
+
+void MbedCloudClientTimeSeries::period_expired() {
+    flush();
+}
@@ -0,0 +1,100 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef MBED_CLOUD_CLIENT_TIMESERIES_H
+#define MBED_CLOUD_CLIENT_TIMESERIES_H
+
+#include "mbed.h"
+#include "mbed-cloud-client-resource.h"
+#include "senml-writer.h"
+
+/**
+ * Buffers timestamped numeric samples on the device and uploads them
+ * in one SenML pack on an OPAQUE resource, instead of one notification per sample.
+ *
+ * Samples are kept in a fixed-size ring buffer, allocated once in the constructor.
+ * The pack is written to the resource when the buffer is full, or when the flush
+ * period expires. While the client is not registered nothing is flushed,
+ * when the buffer is full the oldest sample is overwritten instead.
+ *
+ * Sample times are relative to the time of the flush. When the RTC is set a
+ * base time is included, so the receiver can resolve absolute times.
+ */
+class MbedCloudClientTimeSeries {
+public:
+    /**
+     * @param resource OPAQUE resource the packs are written to, other types are rejected
+     * @param capacity Number of samples in the ring buffer
+     * @param period_ms Flush period, 0 to only flush when the buffer is full
+     * @param format SenmlWriter::CBOR or SenmlWriter::JSON
+     * @param base_name SenML base name of the records, or NULL to leave it out
+     */
+    MbedCloudClientTimeSeries(MbedCloudClientResource *resource, uint32_t capacity, uint32_t period_ms = 0,
+                              SenmlWriter::Format format = SenmlWriter::CBOR, const char *base_name = NULL);
+
+    ~MbedCloudClientTimeSeries();
+
+    /**
+     * Add a sample, timestamped now. Call from thread context.
+     *
+     * @param value Sample value
+     */
+    void add_sample(float value);
+
+    /**
+     * Write all buffered samples to the resource
+     *
+     * @returns Number of samples written, 0 when the buffer was empty or the client is not registered,
+     *          or -1 when the resource is not OPAQUE or the pack did not fit (should not happen)
+     */
+    int flush();
+
+    /**
+     * Number of samples currently buffered
+     */
+    uint32_t get_count();
+
+    /**
+     * Number of samples overwritten before they were flushed
+     */
+    uint32_t get_dropped_count();
+
+private:
+    struct sample {
+        uint64_t time_ms;
+        float value;
+    };
+
+    bool is_registered();
+    void period_expired();
+
+    MbedCloudClientResource *_resource;
+    SenmlWriter::Format _format;
+    const char *_base_name;
+    sample *_samples;
+    uint32_t _capacity;
+    uint32_t _head;
+    uint32_t _count;
+    uint32_t _dropped;
+    uint8_t *_payload;
+    uint32_t _payload_size;
+    int _period_event;
+    Mutex _mutex;
+};
+
+#endif // MBED_CLOUD_CLIENT_TIMESERIES_H
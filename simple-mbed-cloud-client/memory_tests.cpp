@@ -40,6 +40,8 @@
 #include "mbed-client/m2mserver.h"
 #include "mbed-client/m2msecurity.h"
 #include "source/include/m2mreporthandler.h"
+#include "mbed-cloud-client/MbedCloudClient.h"
+#include "resource-helper.h"
 
 #include "mbed.h"
 #include "mbed_stats.h"
@@ -123,6 +125,47 @@ void m2mobject_test_set(M2MObjectList& object_list)
 #endif // MBED_HEAP_STATS_ENABLED
 }
 
+static uint32_t m2mobject_registration_run(int resource_count, bool indexed)
+{
+    M2MObjectList object_list;
+    ResourceIndex index;
+    Timer timer;
+
+    const int instances_per_object = 10;
+
+    timer.start();
+    for (int i = 0; i < resource_count; i++) {
+        M2MResource *resource = add_resource(&object_list, 20000 + (i / instances_per_object), i % instances_per_object,
+                                             5700, "bench", M2MResourceInstance::INTEGER, M2MBase::GET_ALLOWED,
+                                             "", false, NULL, NULL, NULL, indexed ? &index : NULL);
+        assert(resource != NULL);
+    }
+    timer.stop();
+
+    for (int i = 0; i < object_list.size(); i++) {
+        delete object_list[i];
+    }
+
+    return timer.read_us();
+}
+
+void m2mobject_registration_benchmark()
+{
+    const int resource_counts[] = { 10, 100, 1000 };
+
+    printf("*** add_resource registration time in us ***\n");
+    printf("resources    scan       index\n");
+
+    for (unsigned int i = 0; i < sizeof(resource_counts) / sizeof(resource_counts[0]); i++) {
+        uint32_t scan_us = m2mobject_registration_run(resource_counts[i], false);
+        uint32_t index_us = m2mobject_registration_run(resource_counts[i], true);
+        printf("%-12d %-10" PRIu32 " %" PRIu32 "\n", resource_counts[i], scan_us, index_us);
+    }
+
+    heap_stats();
+    printf("*************************************\n\n");
+}
+
 // Note: the mbed-os needs to be compiled with MBED_HEAP_STATS_ENABLED to get
 // functional heap stats, or the mbed_stats_heap_get() will return just zeroes.
 void m2mobject_stats()
@@ -30,4 +30,8 @@ void m2mobject_stats();
 
 void heap_stats();
 
+// Time the creation of 10, 100 and 1000 resources through add_resource,
+// with and without the object/instance index.
+void m2mobject_registration_benchmark();
+
 #endif // !__MEMORY_TESTS_H__
@@ -0,0 +1,95 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "network-failover.h"
+
+NetworkFailover::NetworkFailover()
+    : _fail_threshold(1),
+      _recover_threshold(1),
+      _count(0),
+      _active(0),
+      _switches(0)
+{
+    for (int i = 0; i < NETWORK_FAILOVER_MAX; i++) {
+        _healthy[i] = true;
+        _streak[i] = 0;
+    }
+}
+
+void NetworkFailover::configure(uint32_t fail_threshold, uint32_t recover_threshold) {
+    _fail_threshold = fail_threshold > 0 ? fail_threshold : 1;
+    _recover_threshold = recover_threshold > 0 ? recover_threshold : 1;
+}
+
+int NetworkFailover::add() {
+    if (_count >= NETWORK_FAILOVER_MAX) return -1;
+
+    _healthy[_count] = true;
+    _streak[_count] = 0;
+    return (int)_count++;
+}
+
+uint32_t NetworkFailover::count() const {
+    return _count;
+}
+
+void NetworkFailover::on_probe(uint32_t index, bool healthy) {
+    if (index >= _count) return;
+
+    // The streak counts probes that disagree with the current state
+    if (healthy == _healthy[index]) {
+        _streak[index] = 0;
+        return;
+    }
+
+    _streak[index]++;
+    if (_streak[index] >= (healthy ? _recover_threshold : _fail_threshold)) {
+        _healthy[index] = healthy;
+        _streak[index] = 0;
+    }
+}
+
+bool NetworkFailover::healthy(uint32_t index) const {
+    return index < _count && _healthy[index];
+}
+
+uint32_t NetworkFailover::active() const {
+    return _active;
+}
+
+int NetworkFailover::next() const {
+    for (uint32_t i = 0; i < _count; i++) {
+        if (_healthy[i]) {
+            return i == _active ? -1 : (int)i;
+        }
+    }
+
+    // Nothing is healthy, switching would not help
+    return -1;
+}
+
+void NetworkFailover::on_switched(uint32_t index) {
+    if (index >= _count || index == _active) return;
+
+    _active = index;
+    _switches++;
+}
+
+uint32_t NetworkFailover::switches() const {
+    return _switches;
+}
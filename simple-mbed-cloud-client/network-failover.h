@@ -0,0 +1,111 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef NETWORK_FAILOVER_H
+#define NETWORK_FAILOVER_H
+
+#include <stdint.h>
+
+// Maximum number of network interfaces, including the primary one
+#ifndef NETWORK_FAILOVER_MAX
+#define NETWORK_FAILOVER_MAX 4
+#endif
+
+/**
+ * Picks the network interface to use from an ordered list.
+ *
+ * An interface becomes unhealthy after a number of failed probes in a row,
+ * and healthy again after a (usually larger) number of good probes in a row,
+ * so a flapping link does not cause a switch on every probe. The first
+ * healthy interface in the list is used, which fails back to the primary
+ * interface once it has recovered.
+ *
+ * This class does not depend on Mbed OS, the caller runs the probes.
+ */
+class NetworkFailover {
+public:
+    NetworkFailover();
+
+    /**
+     * Configure the thresholds
+     *
+     * @param fail_threshold Failed probes in a row after which an interface is unhealthy
+     * @param recover_threshold Good probes in a row after which an interface is healthy again
+     */
+    void configure(uint32_t fail_threshold, uint32_t recover_threshold);
+
+    /**
+     * Add an interface at the end of the list, it starts healthy
+     *
+     * @returns Index of the interface, or -1 if the list is full
+     */
+    int add();
+
+    /**
+     * Number of interfaces in the list
+     */
+    uint32_t count() const;
+
+    /**
+     * Record the outcome of a probe, or a failure seen while using the interface
+     *
+     * @param index Index of the interface
+     * @param healthy Whether the probe succeeded
+     */
+    void on_probe(uint32_t index, bool healthy);
+
+    /**
+     * Whether an interface is healthy
+     */
+    bool healthy(uint32_t index) const;
+
+    /**
+     * Index of the interface in use
+     */
+    uint32_t active() const;
+
+    /**
+     * Interface to switch to
+     *
+     * @returns Index of the first healthy interface, or -1 to stay on the active one
+     */
+    int next() const;
+
+    /**
+     * Record a switch to another interface
+     *
+     * @param index Index of the interface now in use
+     */
+    void on_switched(uint32_t index);
+
+    /**
+     * Number of switches
+     */
+    uint32_t switches() const;
+
+private:
+    uint32_t _fail_threshold;
+    uint32_t _recover_threshold;
+    uint32_t _count;
+    uint32_t _active;
+    uint32_t _switches;
+    bool _healthy[NETWORK_FAILOVER_MAX];
+    uint32_t _streak[NETWORK_FAILOVER_MAX];
+};
+
+#endif // NETWORK_FAILOVER_H
@@ -0,0 +1,107 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "notification-coalescer.h"
+
+NotificationCoalescer::NotificationCoalescer()
+    : _min_interval_ms(0),
+      _max_interval_ms(0),
+      _threshold(0.0f),
+      _published(false),
+      _last_value(0.0f),
+      _last_publish_ms(0),
+      _pending(false),
+      _deadline_ms(0),
+      _suppressed(0)
+{
+}
+
+void NotificationCoalescer::configure(uint32_t min_interval_ms, uint32_t max_interval_ms, float threshold) {
+    _min_interval_ms = min_interval_ms;
+    _max_interval_ms = max_interval_ms;
+    _threshold = threshold < 0.0f ? -threshold : threshold;
+}
+
+bool NotificationCoalescer::enabled() const {
+    return _min_interval_ms > 0 || _max_interval_ms > 0 || _threshold > 0.0f;
+}
+
+bool NotificationCoalescer::on_write(float value, bool numeric, uint64_t now_ms) {
+    // The first value always goes out, there is nothing to compare it with
+    if (!_published) {
+        return true;
+    }
+
+    bool significant = true;
+    if (numeric && _threshold > 0.0f) {
+        float delta = value - _last_value;
+        if (delta < 0.0f) delta = -delta;
+        significant = delta >= _threshold;
+    }
+
+    uint64_t deadline;
+    if (significant) {
+        deadline = _last_publish_ms + _min_interval_ms;
+        if (now_ms >= deadline) {
+            if (_pending) {
+                // The held back value is replaced by this one
+                _suppressed++;
+                _pending = false;
+            }
+            return true;
+        }
+    } else if (_max_interval_ms > 0) {
+        deadline = _last_publish_ms + _max_interval_ms;
+    } else {
+        // Dropped, and a held back value is replaced by one that is not worth publishing
+        if (_pending) {
+            _suppressed++;
+            _pending = false;
+        }
+        _suppressed++;
+        return false;
+    }
+
+    if (_pending) {
+        // The held back value is replaced by this one
+        _suppressed++;
+    }
+    _pending = true;
+    _deadline_ms = deadline;
+
+    return false;
+}
+
+void NotificationCoalescer::on_published(float value, uint64_t now_ms) {
+    _published = true;
+    _last_value = value;
+    _last_publish_ms = now_ms;
+    _pending = false;
+}
+
+bool NotificationCoalescer::has_pending() const {
+    return _pending;
+}
+
+uint64_t NotificationCoalescer::deadline_ms() const {
+    return _deadline_ms;
+}
+
+uint32_t NotificationCoalescer::suppressed() const {
+    return _suppressed;
+}
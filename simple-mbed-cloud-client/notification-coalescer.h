@@ -0,0 +1,101 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef NOTIFICATION_COALESCER_H
+#define NOTIFICATION_COALESCER_H
+
+#include <stdint.h>
+
+/**
+ * Decides when writes to a resource are published to Mbed Cloud Client.
+ *
+ * At most one value is published per minimum interval, only the latest
+ * write is kept in between. Numeric writes that differ less than the
+ * threshold from the last published value are held back until the
+ * maximum interval expires (or dropped when there is no maximum interval).
+ * The deadline always follows the latest write, so a held back value that
+ * is replaced by one within the threshold waits for the maximum interval.
+ *
+ * This class does not depend on Mbed OS, time is passed in by the caller.
+ */
+class NotificationCoalescer {
+public:
+    NotificationCoalescer();
+
+    /**
+     * Configure the policy. All zero disables coalescing.
+     *
+     * @param min_interval_ms Minimum time between two published values
+     * @param max_interval_ms Maximum time a held back value waits, 0 to drop values within the threshold
+     * @param threshold Minimum change of a numeric value to be published, 0 to publish every change
+     */
+    void configure(uint32_t min_interval_ms, uint32_t max_interval_ms, float threshold);
+
+    /**
+     * Whether a policy is configured
+     */
+    bool enabled() const;
+
+    /**
+     * Record a write
+     *
+     * @param value Numeric value of the write, ignored when numeric is false
+     * @param numeric Whether the threshold applies to this write
+     * @param now_ms Current time
+     *
+     * @returns true if the value should be published now, false if it is held back
+     */
+    bool on_write(float value, bool numeric, uint64_t now_ms);
+
+    /**
+     * Record that a value was published
+     *
+     * @param value Numeric value that was published
+     * @param now_ms Current time
+     */
+    void on_published(float value, uint64_t now_ms);
+
+    /**
+     * Whether a held back value is waiting to be published
+     */
+    bool has_pending() const;
+
+    /**
+     * Time at which the held back value should be published
+     */
+    uint64_t deadline_ms() const;
+
+    /**
+     * Number of writes that were never published, because a newer
+     * write replaced them or they were within the threshold
+     */
+    uint32_t suppressed() const;
+
+private:
+    uint32_t _min_interval_ms;
+    uint32_t _max_interval_ms;
+    float _threshold;
+    bool _published;
+    float _last_value;
+    uint64_t _last_publish_ms;
+    bool _pending;
+    uint64_t _deadline_ms;
+    uint32_t _suppressed;
+};
+
+#endif // NOTIFICATION_COALESCER_H
@@ -0,0 +1,289 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "notification-queue.h"
+#include "mbed_trace.h"
+#include <errno.h>
+#include <new>
+
+#define TRACE_GROUP "SMCQ"
+
+#define NOTIFICATION_QUEUE_MAGIC 0x514d4353 // "SCMQ"
+
+NotificationQueue::NotificationQueue(const char *path)
+    : _path(NULL), _open(false), _overflow(MCC_QUEUE_DROP_OLDEST), _sync_interval(1), _changes(0)
+{
+    size_t len = strlen(path);
+    _path = new char[len + 1];
+    memcpy(_path, path, len + 1);
+
+    memset(&_header, 0, sizeof(_header));
+    _committed = _header;
+}
+
+NotificationQueue::~NotificationQueue() {
+    close();
+    delete[] _path;
+}
+
+int NotificationQueue::open(FileSystem *fs, uint32_t capacity, mcc_queue_overflow overflow, uint32_t sync_interval) {
+    close();
+    if (!fs || capacity == 0) return -1;
+
+    _overflow = overflow;
+    _sync_interval = sync_interval > 0 ? sync_interval : 1;
+    _changes = 0;
+
+    int status = _file.open(fs, _path, O_RDWR | O_CREAT);
+    if (status != 0) {
+        tr_error("Could not open %s (%d)", _path, status);
+        return status;
+    }
+    _open = true;
+
+    // Keep the records of a previous boot if the layout matches
+    header existing;
+    if (_file.read(&existing, sizeof(existing)) == (ssize_t)sizeof(existing) &&
+        existing.magic == NOTIFICATION_QUEUE_MAGIC &&
+        existing.record_size == sizeof(mcc_queued_record) &&
+        existing.capacity == capacity &&
+        existing.head < capacity && existing.count <= capacity) {
+        _header = existing;
+        _committed = existing;
+        tr_info("Restored %lu queued records", (unsigned long)_header.count);
+        return 0;
+    }
+
+    memset(&_header, 0, sizeof(_header));
+    _header.magic = NOTIFICATION_QUEUE_MAGIC;
+    _header.record_size = sizeof(mcc_queued_record);
+    _header.capacity = capacity;
+
+    status = write_header();
+    if (status != 0) {
+        close();
+    }
+    return status;
+}
+
+int NotificationQueue::sync() {
+    if (!_open) return -1;
+    if (_changes == 0) return 0;
+
+    return write_header();
+}
+
+void NotificationQueue::close() {
+    if (!_open) return;
+
+    sync();
+    _open = false;
+    _file.close();
+}
+
+bool NotificationQueue::is_open() const {
+    return _open;
+}
+
+int NotificationQueue::push(const mcc_queued_record *record) {
+    if (!_open) return -1;
+
+    if (_header.count == _header.capacity) {
+        if (_overflow == MCC_QUEUE_DROP_NEWEST) {
+            _header.dropped++;
+            return changed() == 0 ? 1 : -1;
+        }
+
+        if (_overflow == MCC_QUEUE_DOWNSAMPLE && _header.capacity > 1) {
+            // downsample() counts what it drops, the new record is kept
+            int status = downsample();
+            if (status != 0) return status;
+        }
+
+        // Not downsampling, or every record is the newest of its resource
+        if (_header.count == _header.capacity) {
+            _header.head = (_header.head + 1) % _header.capacity;
+            _header.count--;
+            _header.dropped++;
+        }
+    }
+
+    // The slot still holds a record as far as the file is concerned, commit first
+    if (committed(_header.count)) {
+        int status = write_header();
+        if (status != 0) return status;
+    }
+
+    int status = write_record(_header.count, record);
+    if (status != 0) return status;
+
+    _header.count++;
+    return changed();
+}
+
+int NotificationQueue::peek(mcc_queued_record *record) {
+    if (!_open) return -1;
+    if (_header.count == 0) return 1;
+
+    return read_record(0, record);
+}
+
+int NotificationQueue::pop() {
+    if (!_open) return -1;
+    if (_header.count == 0) return 0;
+
+    _header.head = (_header.head + 1) % _header.capacity;
+    _header.count--;
+    return changed();
+}
+
+uint32_t NotificationQueue::count() const {
+    return _header.count;
+}
+
+uint32_t NotificationQueue::dropped() const {
+    return _header.dropped;
+}
+
+int NotificationQueue::read_record(uint32_t index, mcc_queued_record *record) {
+    uint32_t slot = (_header.head + index) % _header.capacity;
+    _file.seek(sizeof(header) + slot * sizeof(mcc_queued_record), SEEK_SET);
+
+    ssize_t length = _file.read(record, sizeof(mcc_queued_record));
+    if (length != (ssize_t)sizeof(mcc_queued_record)) {
+        tr_error("Reading %s failed (%d)", _path, (int)length);
+        return length < 0 ? (int)length : -1;
+    }
+    return 0;
+}
+
+int NotificationQueue::write_record(uint32_t index, const mcc_queued_record *record) {
+    uint32_t slot = (_header.head + index) % _header.capacity;
+    _file.seek(sizeof(header) + slot * sizeof(mcc_queued_record), SEEK_SET);
+
+    ssize_t length = _file.write(record, sizeof(mcc_queued_record));
+    if (length != (ssize_t)sizeof(mcc_queued_record)) {
+        tr_error("Writing %s failed (%d)", _path, (int)length);
+        return length < 0 ? (int)length : -1;
+    }
+    return 0;
+}
+
+int NotificationQueue::write_header() {
+    _file.seek(0, SEEK_SET);
+
+    ssize_t length = _file.write(&_header, sizeof(_header));
+    if (length != (ssize_t)sizeof(_header)) {
+        tr_error("Writing %s failed (%d)", _path, (int)length);
+        return length < 0 ? (int)length : -1;
+    }
+
+    // Commit, so the queue survives a reset
+    int status = _file.sync();
+    if (status == 0) {
+        _committed = _header;
+        _changes = 0;
+    }
+    return status;
+}
+
+int NotificationQueue::changed() {
+    if (++_changes < _sync_interval) return 0;
+
+    return write_header();
+}
+
+bool NotificationQueue::committed(uint32_t index) const {
+    uint32_t slot = (_header.head + index) % _header.capacity;
+    return (slot + _header.capacity - _committed.head) % _header.capacity < _committed.count;
+}
+
+int NotificationQueue::downsample() {
+    // Per resource, keep every second record counting back from its newest, so interleaved
+    // resources each keep half of their history and the latest value of each one survives.
+    // Walks the records newest first, counting the newer records of the same resource.
+    struct newer_records {
+        uint16_t object_id;
+        uint16_t instance_id;
+        uint16_t resource_id;
+        uint32_t newer;
+    };
+
+    uint32_t count = _header.count;
+    newer_records *resources = new (std::nothrow) newer_records[count];
+    uint8_t *keep = new (std::nothrow) uint8_t[(count + 7) / 8];
+    if (!resources || !keep) {
+        tr_error("Could not allocate memory to downsample the queue");
+        delete[] resources;
+        delete[] keep;
+        return -ENOMEM;
+    }
+    memset(keep, 0, (count + 7) / 8);
+
+    mcc_queued_record record;
+    uint32_t used = 0;
+    int status = 0;
+    for (uint32_t i = count; i-- > 0; ) {
+        status = read_record(i, &record);
+        if (status != 0) break;
+
+        uint32_t r = 0;
+        while (r < used &&
+               (resources[r].object_id != record.object_id || resources[r].instance_id != record.instance_id ||
+                resources[r].resource_id != record.resource_id)) {
+            r++;
+        }
+        if (r == used) {
+            resources[r].object_id = record.object_id;
+            resources[r].instance_id = record.instance_id;
+            resources[r].resource_id = record.resource_id;
+            resources[r].newer = 0;
+            used++;
+        }
+
+        if ((resources[r].newer++ & 1) == 0) {
+            keep[i / 8] |= 1 << (i % 8);
+        }
+    }
+
+    // Move the kept records towards the head. Reading ahead of the write position,
+    // so no record is overwritten before it is read.
+    uint32_t kept = 0;
+    for (uint32_t i = 0; status == 0 && i < count; i++) {
+        if (!(keep[i / 8] & (1 << (i % 8)))) continue;
+
+        if (i != kept) {
+            status = read_record(i, &record);
+            if (status == 0) {
+                status = write_record(kept, &record);
+            }
+        }
+        kept++;
+    }
+
+    delete[] resources;
+    delete[] keep;
+    if (status != 0) return status;
+
+    tr_debug("Downsampled queue from %lu to %lu records", (unsigned long)count, (unsigned long)kept);
+    _header.dropped += count - kept;
+    _header.count = kept;
+
+    // The records moved, so the committed header no longer matches the slots
+    return write_header();
+}
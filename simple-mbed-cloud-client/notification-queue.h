@@ -0,0 +1,160 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef NOTIFICATION_QUEUE_H
+#define NOTIFICATION_QUEUE_H
+
+#include "mbed.h"
+#include "FileSystem.h"
+
+// Longest value a queued record can hold, longer values are not queued
+#define MCC_QUEUE_VALUE_SIZE 24
+
+/**
+ * A resource value written while the client was offline
+ */
+struct mcc_queued_record {
+    uint16_t object_id;
+    uint16_t instance_id;
+    uint16_t resource_id;
+    uint8_t length;                         // Number of bytes used in 'value'
+    uint8_t reserved;
+    uint32_t timestamp;                     // time(NULL) of the write, seconds
+    uint8_t value[MCC_QUEUE_VALUE_SIZE];
+};
+
+/**
+ * What NotificationQueue does with a record when it is full
+ */
+enum mcc_queue_overflow {
+    MCC_QUEUE_DROP_OLDEST,      // Overwrite the oldest record
+    MCC_QUEUE_DROP_NEWEST,      // Discard the new record
+    MCC_QUEUE_DOWNSAMPLE        // Drop every second record of each resource, halving the resolution of its history.
+                                // The newest record of each resource is kept.
+};
+
+/**
+ * Bounded FIFO of records, kept in a file so it survives a reboot.
+ *
+ * The file holds a header and a fixed number of record slots used as a ring buffer,
+ * so appending a record writes one slot. The header, which says which slots hold records,
+ * is committed to the file every 'sync_interval' pushes and pops, to spare the flash.
+ * A power loss before the next commit loses the records pushed since the last one,
+ * and sends the records popped since then again. A slot that the committed header still
+ * counts as a record is never written before the header is committed, so the file
+ * always holds a consistent queue.
+ */
+class NotificationQueue {
+public:
+    /**
+     * @param path Path of the file, relative to the file system, copied
+     */
+    NotificationQueue(const char *path);
+
+    ~NotificationQueue();
+
+    /**
+     * Open the queue. Records of a previous boot are kept when the file has the same capacity,
+     * otherwise the file is recreated.
+     *
+     * @param fs File system to store the file on
+     * @param capacity Maximum number of records
+     * @param overflow What to do when the queue is full
+     * @param sync_interval Number of pushes and pops between two commits of the header, 1 = commit every change
+     *
+     * @returns 0 if successful, negative error code if not
+     */
+    int open(FileSystem *fs, uint32_t capacity, mcc_queue_overflow overflow, uint32_t sync_interval = 1);
+
+    /**
+     * Commit the header to the file, so all pushes and pops so far survive a power loss
+     *
+     * @returns 0 if successful, negative error code if not
+     */
+    int sync();
+
+    /**
+     * Commit the header and close the file, the records stay in it
+     */
+    void close();
+
+    /**
+     * Whether the queue is open
+     */
+    bool is_open() const;
+
+    /**
+     * Append a record
+     *
+     * @returns 0 if stored, 1 if dropped because the queue is full, negative error code if not
+     */
+    int push(const mcc_queued_record *record);
+
+    /**
+     * Read the oldest record without removing it
+     *
+     * @returns 0 if successful, 1 if the queue is empty, negative error code if not
+     */
+    int peek(mcc_queued_record *record);
+
+    /**
+     * Remove the oldest record
+     *
+     * @returns 0 if successful, negative error code if not
+     */
+    int pop();
+
+    /**
+     * Number of records in the queue
+     */
+    uint32_t count() const;
+
+    /**
+     * Number of records dropped because the queue was full, including previous boots
+     */
+    uint32_t dropped() const;
+
+private:
+    struct header {
+        uint32_t magic;
+        uint16_t record_size;
+        uint16_t reserved;
+        uint32_t capacity;
+        uint32_t head;
+        uint32_t count;
+        uint32_t dropped;
+    };
+
+    int read_record(uint32_t index, mcc_queued_record *record);
+    int write_record(uint32_t index, const mcc_queued_record *record);
+    int write_header();
+    int changed();
+    bool committed(uint32_t index) const;
+    int downsample();
+
+    char *_path;
+    File _file;
+    bool _open;
+    mcc_queue_overflow _overflow;
+    header _header;
+    header _committed;              // Header as last written to the file
+    uint32_t _sync_interval;
+    uint32_t _changes;              // Pushes and pops since the header was written
+};
+
+#endif // NOTIFICATION_QUEUE_H
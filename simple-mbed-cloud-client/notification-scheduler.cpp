@@ -0,0 +1,248 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "notification-scheduler.h"
+#include <string.h>
+
+NotificationScheduler::Entry::Entry()
+    : owner(NULL),
+      next(NULL),
+      next_in_flight(NULL),
+      priority(MCC_PRIORITY_NORMAL),
+      queued(false),
+      in_flight(false),
+      queued_ms(0),
+      sent_queued_ms(0),
+      sent_ms(0)
+{
+}
+
+NotificationScheduler::NotificationScheduler()
+    : _max_in_flight(0),
+      _max_pending(0),
+      _in_flight(0),
+      _pending(0),
+      _in_flight_list(NULL)
+{
+    for (int i = 0; i < MCC_PRIORITY_COUNT; i++) {
+        _head[i] = NULL;
+        _tail[i] = NULL;
+    }
+    memset(_stats, 0, sizeof(_stats));
+}
+
+void NotificationScheduler::configure(uint32_t max_in_flight, uint32_t max_pending) {
+    _max_in_flight = max_in_flight;
+    _max_pending = max_pending;
+}
+
+bool NotificationScheduler::enabled() const {
+    return _max_in_flight > 0;
+}
+
+NotificationScheduler::Entry *NotificationScheduler::enqueue(Entry *entry, uint64_t now_ms) {
+    // Already queued, the newer value goes out with the queued notification
+    if (entry->queued) return NULL;
+
+    uint8_t priority = entry->priority;
+    Entry *dropped = NULL;
+
+    if (_max_pending > 0 && _pending >= _max_pending) {
+        int lowest = MCC_PRIORITY_COUNT - 1;
+        while (lowest >= 0 && !_head[lowest]) {
+            lowest--;
+        }
+
+        if (lowest > priority || (lowest == priority && priority != MCC_PRIORITY_HIGH)) {
+            // Shed the oldest notification of the lowest class
+            dropped = _head[lowest];
+            unlink(dropped);
+            _stats[lowest].dropped++;
+        } else if (priority != MCC_PRIORITY_HIGH) {
+            // Everything queued is more important
+            _stats[priority].dropped++;
+            return entry;
+        }
+        // High priority notifications go over the limit rather than being dropped
+    }
+
+    entry->queued_ms = now_ms;
+    push_back(entry);
+    _stats[priority].queued++;
+
+    return dropped;
+}
+
+NotificationScheduler::Entry *NotificationScheduler::next(uint64_t now_ms) {
+    if (_max_in_flight > 0 && _in_flight >= _max_in_flight) return NULL;
+
+    for (int priority = 0; priority < MCC_PRIORITY_COUNT; priority++) {
+        // A resource has one notification in flight at a time
+        Entry *entry = _head[priority];
+        while (entry && entry->in_flight) {
+            entry = entry->next;
+        }
+        if (!entry) continue;
+
+        unlink(entry);
+        entry->in_flight = true;
+        entry->sent_queued_ms = entry->queued_ms;
+        entry->sent_ms = now_ms;
+        entry->next_in_flight = _in_flight_list;
+        _in_flight_list = entry;
+        _in_flight++;
+        _stats[priority].sent++;
+        return entry;
+    }
+
+    return NULL;
+}
+
+void NotificationScheduler::complete(Entry *entry, bool delivered, uint64_t now_ms) {
+    if (!entry->in_flight) return;
+
+    unlink_in_flight(entry);
+
+    mcc_priority_stats *stats = &_stats[entry->priority];
+    if (delivered) {
+        uint64_t latency = now_ms > entry->sent_queued_ms ? now_ms - entry->sent_queued_ms : 0;
+        stats->delivered++;
+        stats->total_latency_ms += latency;
+        if (latency > stats->max_latency_ms) {
+            stats->max_latency_ms = (uint32_t)latency;
+        }
+    } else if (entry->priority == MCC_PRIORITY_HIGH) {
+        // Try again before anything else, keeping the original time for the latency
+        if (!entry->queued) {
+            entry->queued_ms = entry->sent_queued_ms;
+            push_front(entry);
+        }
+    } else {
+        stats->dropped++;
+    }
+}
+
+uint32_t NotificationScheduler::expire(uint64_t now_ms, uint32_t timeout_ms) {
+    uint32_t expired = 0;
+    Entry *entry = _in_flight_list;
+    while (entry) {
+        // complete() unlinks the entry
+        Entry *next_in_flight = entry->next_in_flight;
+        if (now_ms >= entry->sent_ms + timeout_ms) {
+            complete(entry, false, now_ms);
+            expired++;
+        }
+        entry = next_in_flight;
+    }
+    return expired;
+}
+
+bool NotificationScheduler::oldest_in_flight(uint64_t *sent_ms) const {
+    if (!_in_flight_list) return false;
+
+    uint64_t oldest = _in_flight_list->sent_ms;
+    for (Entry *entry = _in_flight_list->next_in_flight; entry; entry = entry->next_in_flight) {
+        if (entry->sent_ms < oldest) {
+            oldest = entry->sent_ms;
+        }
+    }
+    *sent_ms = oldest;
+    return true;
+}
+
+void NotificationScheduler::reset_in_flight() {
+    // The list holds the newest first, so the oldest high priority one ends up at the front
+    while (_in_flight_list) {
+        complete(_in_flight_list, false, 0);
+    }
+}
+
+void NotificationScheduler::remove(Entry *entry) {
+    if (entry->queued) {
+        unlink(entry);
+    }
+    if (entry->in_flight) {
+        unlink_in_flight(entry);
+    }
+}
+
+uint32_t NotificationScheduler::pending() const {
+    return _pending;
+}
+
+mcc_priority_stats NotificationScheduler::stats(mcc_priority priority) const {
+    return _stats[priority];
+}
+
+void NotificationScheduler::push_back(Entry *entry) {
+    uint8_t priority = entry->priority;
+    entry->next = NULL;
+    if (_tail[priority]) {
+        _tail[priority]->next = entry;
+    } else {
+        _head[priority] = entry;
+    }
+    _tail[priority] = entry;
+    entry->queued = true;
+    _pending++;
+}
+
+void NotificationScheduler::push_front(Entry *entry) {
+    uint8_t priority = entry->priority;
+    entry->next = _head[priority];
+    _head[priority] = entry;
+    if (!_tail[priority]) {
+        _tail[priority] = entry;
+    }
+    entry->queued = true;
+    _pending++;
+}
+
+void NotificationScheduler::unlink(Entry *entry) {
+    uint8_t priority = entry->priority;
+    Entry *prev = NULL;
+    for (Entry *e = _head[priority]; e; prev = e, e = e->next) {
+        if (e != entry) continue;
+
+        if (prev) {
+            prev->next = e->next;
+        } else {
+            _head[priority] = e->next;
+        }
+        if (_tail[priority] == e) {
+            _tail[priority] = prev;
+        }
+        break;
+    }
+    entry->next = NULL;
+    entry->queued = false;
+    _pending--;
+}
+
+void NotificationScheduler::unlink_in_flight(Entry *entry) {
+    Entry **link = &_in_flight_list;
+    while (*link && *link != entry) {
+        link = &(*link)->next_in_flight;
+    }
+    if (*link) {
+        *link = entry->next_in_flight;
+    }
+    entry->next_in_flight = NULL;
+    entry->in_flight = false;
+    _in_flight--;
+}
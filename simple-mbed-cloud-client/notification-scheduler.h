@@ -0,0 +1,176 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef NOTIFICATION_SCHEDULER_H
+#define NOTIFICATION_SCHEDULER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Priority class of the notifications of a resource
+ */
+enum mcc_priority {
+    MCC_PRIORITY_HIGH = 0,      // Sent first, never dropped (e.g. alarms)
+    MCC_PRIORITY_NORMAL,
+    MCC_PRIORITY_LOW,           // Dropped first (e.g. bulk telemetry)
+    MCC_PRIORITY_COUNT
+};
+
+/**
+ * Counters of one priority class
+ */
+struct mcc_priority_stats {
+    uint32_t queued;            // Notifications queued
+    uint32_t sent;              // Notifications handed to Mbed Cloud Client
+    uint32_t delivered;         // Notifications acknowledged
+    uint32_t dropped;           // Notifications dropped because the queue was full, or failed to send
+    uint32_t max_latency_ms;    // Longest time from queued to acknowledged
+    uint64_t total_latency_ms;  // Sum of the times from queued to acknowledged, divide by 'delivered' for the mean
+};
+
+/**
+ * Orders outbound notifications by priority class and limits how many are in flight.
+ *
+ * Each resource has one entry, so a resource is queued at most once and a newer value
+ * replaces the queued one. When the queue is full the oldest notification of the lowest
+ * class is dropped; high priority notifications are never dropped, and are queued again
+ * when sending them fails. A notification that is not acknowledged in time counts as failed,
+ * so it does not hold its place in flight forever.
+ *
+ * This class does not depend on Mbed OS, time is passed in by the caller.
+ */
+class NotificationScheduler {
+public:
+    /**
+     * Queue entry, embedded in the object that sends the notification
+     */
+    struct Entry {
+        Entry();
+
+        void *owner;
+        Entry *next;
+        Entry *next_in_flight;
+        uint8_t priority;
+        bool queued;
+        bool in_flight;
+        uint64_t queued_ms;
+        uint64_t sent_queued_ms;
+        uint64_t sent_ms;
+    };
+
+    NotificationScheduler();
+
+    /**
+     * Configure the limits. A max_in_flight of 0 disables scheduling.
+     *
+     * @param max_in_flight Notifications sent but not acknowledged at the same time
+     * @param max_pending Notifications waiting to be sent
+     */
+    void configure(uint32_t max_in_flight, uint32_t max_pending);
+
+    /**
+     * Whether scheduling is enabled
+     */
+    bool enabled() const;
+
+    /**
+     * Queue a notification
+     *
+     * @param entry Entry of the resource, with its priority set
+     * @param now_ms Current time
+     *
+     * @returns The entry that was dropped to make room (possibly 'entry' itself), or NULL
+     */
+    Entry *enqueue(Entry *entry, uint64_t now_ms);
+
+    /**
+     * Take the next notification to send, if fewer than max_in_flight are in flight (any number when 0)
+     *
+     * @param now_ms Current time
+     *
+     * @returns The entry to send, or NULL
+     */
+    Entry *next(uint64_t now_ms);
+
+    /**
+     * Record that a notification was acknowledged or failed
+     *
+     * @param entry Entry that was sent
+     * @param delivered Whether it was acknowledged
+     * @param now_ms Current time
+     */
+    void complete(Entry *entry, bool delivered, uint64_t now_ms);
+
+    /**
+     * Fail the notifications that have been in flight for timeout_ms or longer
+     *
+     * @param now_ms Current time
+     * @param timeout_ms Time a notification may stay in flight
+     *
+     * @returns Number of notifications failed
+     */
+    uint32_t expire(uint64_t now_ms, uint32_t timeout_ms);
+
+    /**
+     * Time the oldest notification in flight was sent
+     *
+     * @param sent_ms Receives the time
+     *
+     * @returns false if no notification is in flight
+     */
+    bool oldest_in_flight(uint64_t *sent_ms) const;
+
+    /**
+     * Fail all notifications in flight, e.g. after the client unregistered.
+     * High priority ones are queued again, before anything else, the others are dropped.
+     */
+    void reset_in_flight();
+
+    /**
+     * Remove an entry from the queue, e.g. when its owner is destroyed
+     */
+    void remove(Entry *entry);
+
+    /**
+     * Number of queued notifications
+     */
+    uint32_t pending() const;
+
+    /**
+     * Counters of a priority class
+     */
+    mcc_priority_stats stats(mcc_priority priority) const;
+
+private:
+    void push_back(Entry *entry);
+    void push_front(Entry *entry);
+    void unlink(Entry *entry);
+    void unlink_in_flight(Entry *entry);
+
+    uint32_t _max_in_flight;
+    uint32_t _max_pending;
+    uint32_t _in_flight;
+    uint32_t _pending;
+    Entry *_head[MCC_PRIORITY_COUNT];
+    Entry *_tail[MCC_PRIORITY_COUNT];
+    Entry *_in_flight_list;
+    mcc_priority_stats _stats[MCC_PRIORITY_COUNT];
+};
+
+#endif // NOTIFICATION_SCHEDULER_H
@@ -0,0 +1,135 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "reconnect-backoff.h"
+
+ReconnectBackoff::ReconnectBackoff()
+    : _base_delay_ms(1000),
+      _max_delay_ms(600000),
+      _retry_budget(0),
+      _link_up_jitter_ms(5000),
+      _random_state(0x2545f491),
+      _attempts(0),
+      _link_up(true),
+      _waiting(false),
+      _pending(false),
+      _next_attempt_ms(0)
+{
+}
+
+void ReconnectBackoff::configure(uint32_t base_delay_ms, uint32_t max_delay_ms, uint32_t retry_budget, uint32_t link_up_jitter_ms) {
+    _base_delay_ms = base_delay_ms;
+    _max_delay_ms = max_delay_ms < base_delay_ms ? base_delay_ms : max_delay_ms;
+    _retry_budget = retry_budget;
+    _link_up_jitter_ms = link_up_jitter_ms;
+}
+
+void ReconnectBackoff::seed(uint32_t seed) {
+    // xorshift32 never leaves the all-zero state
+    _random_state = seed ? seed : 0x2545f491;
+}
+
+bool ReconnectBackoff::on_failure(uint64_t now_ms) {
+    _pending = false;
+
+    if (exhausted()) {
+        _waiting = false;
+        return false;
+    }
+
+    _waiting = true;
+    if (!_link_up) {
+        return false;
+    }
+
+    // Cap grows as base * 2^attempts, without overflowing
+    uint32_t cap = _base_delay_ms;
+    for (uint32_t i = 0; i < _attempts && cap < _max_delay_ms; i++) {
+        cap = cap > _max_delay_ms / 2 ? _max_delay_ms : cap * 2;
+    }
+
+    return schedule(now_ms, cap);
+}
+
+bool ReconnectBackoff::on_link_up(uint64_t now_ms) {
+    _link_up = true;
+
+    if (!_waiting || exhausted()) {
+        return false;
+    }
+
+    uint32_t delay = random(_link_up_jitter_ms);
+    if (_pending && _next_attempt_ms <= now_ms + delay) {
+        // Already due sooner
+        return true;
+    }
+
+    _pending = true;
+    _next_attempt_ms = now_ms + delay;
+    return true;
+}
+
+void ReconnectBackoff::on_link_down() {
+    _link_up = false;
+    _pending = false;
+}
+
+void ReconnectBackoff::on_attempt() {
+    _pending = false;
+    _waiting = false;
+    _attempts++;
+}
+
+void ReconnectBackoff::on_success() {
+    _attempts = 0;
+    _pending = false;
+    _waiting = false;
+}
+
+bool ReconnectBackoff::pending() const {
+    return _pending;
+}
+
+uint64_t ReconnectBackoff::next_attempt_ms() const {
+    return _next_attempt_ms;
+}
+
+uint32_t ReconnectBackoff::attempts() const {
+    return _attempts;
+}
+
+bool ReconnectBackoff::exhausted() const {
+    return _retry_budget > 0 && _attempts >= _retry_budget;
+}
+
+bool ReconnectBackoff::schedule(uint64_t now_ms, uint32_t max_delay_ms) {
+    _pending = true;
+    _next_attempt_ms = now_ms + random(max_delay_ms);
+    return true;
+}
+
+uint32_t ReconnectBackoff::random(uint32_t max) {
+    uint32_t x = _random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    _random_state = x;
+
+    if (max == 0) return 0;
+    return (uint32_t)(((uint64_t)x * ((uint64_t)max + 1)) >> 32);
+}
@@ -0,0 +1,123 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef RECONNECT_BACKOFF_H
+#define RECONNECT_BACKOFF_H
+
+#include <stdint.h>
+
+/**
+ * Decides when to try registering again after the connection was lost.
+ *
+ * The delay before attempt n is drawn uniformly from [0, min(max_delay, base_delay * 2^n)]
+ * ("full jitter"), so devices that lost the connection at the same moment spread their
+ * attempts out. A retry budget limits the number of attempts until the next success.
+ * While the link is down no attempt is scheduled; when the link comes back up the next
+ * attempt is brought forward to within a short jitter window.
+ *
+ * This class does not depend on Mbed OS, time and the random seed are passed in by the caller.
+ */
+class ReconnectBackoff {
+public:
+    ReconnectBackoff();
+
+    /**
+     * Configure the policy
+     *
+     * @param base_delay_ms Upper bound of the delay before the first attempt
+     * @param max_delay_ms Upper bound of the delay before any attempt
+     * @param retry_budget Number of attempts until the next success, 0 for no limit
+     * @param link_up_jitter_ms Upper bound of the delay after the link came up
+     */
+    void configure(uint32_t base_delay_ms, uint32_t max_delay_ms, uint32_t retry_budget, uint32_t link_up_jitter_ms);
+
+    /**
+     * Seed the random generator, should differ between devices
+     */
+    void seed(uint32_t seed);
+
+    /**
+     * Record that the connection was lost or an attempt failed, and schedule the next attempt
+     *
+     * @param now_ms Current time
+     *
+     * @returns true if an attempt is scheduled, false if the budget is exhausted or the link is down
+     */
+    bool on_failure(uint64_t now_ms);
+
+    /**
+     * Record that the link came up. A scheduled or waiting attempt is brought forward.
+     *
+     * @param now_ms Current time
+     *
+     * @returns true if an attempt is scheduled
+     */
+    bool on_link_up(uint64_t now_ms);
+
+    /**
+     * Record that the link went down. The scheduled attempt waits for the link to come up.
+     */
+    void on_link_down();
+
+    /**
+     * Record that the attempt scheduled for now was started
+     */
+    void on_attempt();
+
+    /**
+     * Record a successful registration, this resets the delay and the budget
+     */
+    void on_success();
+
+    /**
+     * Whether an attempt is scheduled
+     */
+    bool pending() const;
+
+    /**
+     * Time of the scheduled attempt
+     */
+    uint64_t next_attempt_ms() const;
+
+    /**
+     * Number of attempts since the last success
+     */
+    uint32_t attempts() const;
+
+    /**
+     * Whether the retry budget is used up
+     */
+    bool exhausted() const;
+
+private:
+    uint32_t random(uint32_t max);
+    bool schedule(uint64_t now_ms, uint32_t max_delay_ms);
+
+    uint32_t _base_delay_ms;
+    uint32_t _max_delay_ms;
+    uint32_t _retry_budget;
+    uint32_t _link_up_jitter_ms;
+    uint32_t _random_state;
+    uint32_t _attempts;
+    bool _link_up;
+    bool _waiting;
+    bool _pending;
+    uint64_t _next_attempt_ms;
+};
+
+#endif // RECONNECT_BACKOFF_H
@@ -0,0 +1,87 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "registration-update-debouncer.h"
+
+RegistrationUpdateDebouncer::RegistrationUpdateDebouncer()
+    : _window_ms(0),
+      _pending(false),
+      _in_flight(false),
+      _deadline_ms(0),
+      _issued(0),
+      _merged(0)
+{
+}
+
+void RegistrationUpdateDebouncer::configure(uint32_t window_ms) {
+    _window_ms = window_ms;
+}
+
+bool RegistrationUpdateDebouncer::on_request(uint64_t now_ms) {
+    if (_pending) {
+        _merged++;
+        return false;
+    }
+
+    _pending = true;
+    _deadline_ms = now_ms + _window_ms;
+
+    return issue(now_ms);
+}
+
+bool RegistrationUpdateDebouncer::on_timer(uint64_t now_ms) {
+    return issue(now_ms);
+}
+
+bool RegistrationUpdateDebouncer::on_completed(uint64_t now_ms) {
+    _in_flight = false;
+
+    return issue(now_ms);
+}
+
+bool RegistrationUpdateDebouncer::pending() const {
+    return _pending;
+}
+
+bool RegistrationUpdateDebouncer::in_flight() const {
+    return _in_flight;
+}
+
+uint64_t RegistrationUpdateDebouncer::deadline_ms() const {
+    return _deadline_ms;
+}
+
+uint32_t RegistrationUpdateDebouncer::issued() const {
+    return _issued;
+}
+
+uint32_t RegistrationUpdateDebouncer::merged() const {
+    return _merged;
+}
+
+bool RegistrationUpdateDebouncer::issue(uint64_t now_ms) {
+    if (!_pending || _in_flight || now_ms < _deadline_ms) {
+        return false;
+    }
+
+    _pending = false;
+    _in_flight = true;
+    _issued++;
+
+    return true;
+}
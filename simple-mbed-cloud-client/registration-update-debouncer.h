@@ -0,0 +1,107 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef REGISTRATION_UPDATE_DEBOUNCER_H
+#define REGISTRATION_UPDATE_DEBOUNCER_H
+
+#include <stdint.h>
+
+/**
+ * Merges registration update requests.
+ *
+ * A request waits for the window to expire, and all requests within the window
+ * are merged into one update. While an update is in flight, requests are merged
+ * into one queued update that is issued when the update in flight completes.
+ *
+ * This class does not depend on Mbed OS, time is passed in by the caller.
+ */
+class RegistrationUpdateDebouncer {
+public:
+    RegistrationUpdateDebouncer();
+
+    /**
+     * Configure the window
+     *
+     * @param window_ms Time to wait for more requests before issuing an update, 0 to issue at once
+     */
+    void configure(uint32_t window_ms);
+
+    /**
+     * Record a request for a registration update
+     *
+     * @param now_ms Current time
+     *
+     * @returns true if the update should be issued now
+     */
+    bool on_request(uint64_t now_ms);
+
+    /**
+     * Check the window of the queued request
+     *
+     * @param now_ms Current time
+     *
+     * @returns true if the update should be issued now
+     */
+    bool on_timer(uint64_t now_ms);
+
+    /**
+     * Record that the update in flight completed or failed
+     *
+     * @param now_ms Current time
+     *
+     * @returns true if the queued update should be issued now
+     */
+    bool on_completed(uint64_t now_ms);
+
+    /**
+     * Whether a request is queued
+     */
+    bool pending() const;
+
+    /**
+     * Whether an update is in flight
+     */
+    bool in_flight() const;
+
+    /**
+     * Time at which the window of the queued request expires
+     */
+    uint64_t deadline_ms() const;
+
+    /**
+     * Number of updates issued
+     */
+    uint32_t issued() const;
+
+    /**
+     * Number of requests merged into another request
+     */
+    uint32_t merged() const;
+
+private:
+    bool issue(uint64_t now_ms);
+
+    uint32_t _window_ms;
+    bool _pending;
+    bool _in_flight;
+    uint64_t _deadline_ms;
+    uint32_t _issued;
+    uint32_t _merged;
+};
+
+#endif // REGISTRATION_UPDATE_DEBOUNCER_H
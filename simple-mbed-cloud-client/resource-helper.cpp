@@ -21,7 +21,99 @@
 #include "mbed-client/m2minterface.h"
 #include <stdio.h>
 #include <string.h>
+#include <new>
 #include "mbed.h"
+#include "resource-helper.h"
+#include "mbed_trace.h"
+
+#define TRACE_GROUP "SMCH"
+
+#define RESOURCE_INDEX_KEY(object_id, instance_id) (((uint32_t)(object_id) << 16) | (instance_id))
+
+ResourceIndex::ResourceIndex()
+    : _entries(NULL), _count(0), _capacity(0), _valid(true)
+{
+}
+
+ResourceIndex::~ResourceIndex() {
+    clear();
+}
+
+void ResourceIndex::clear() {
+    delete[] _entries;
+    _entries = NULL;
+    _count = 0;
+    _capacity = 0;
+    _valid = true;
+}
+
+bool ResourceIndex::valid() const {
+    return _valid;
+}
+
+uint32_t ResourceIndex::lower_bound(uint32_t key) const {
+    uint32_t low = 0;
+    uint32_t high = _count;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (_entries[mid].key < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+M2MObject* ResourceIndex::find_object(uint16_t object_id) const {
+    uint32_t pos = lower_bound(RESOURCE_INDEX_KEY(object_id, 0));
+    if (pos < _count && (_entries[pos].key >> 16) == object_id) {
+        return _entries[pos].object;
+    }
+    return NULL;
+}
+
+M2MObjectInstance* ResourceIndex::find_instance(uint16_t object_id, uint16_t instance_id) const {
+    uint32_t key = RESOURCE_INDEX_KEY(object_id, instance_id);
+    uint32_t pos = lower_bound(key);
+    if (pos < _count && _entries[pos].key == key) {
+        return _entries[pos].instance;
+    }
+    return NULL;
+}
+
+bool ResourceIndex::insert(uint16_t object_id, uint16_t instance_id, M2MObject *object, M2MObjectInstance *instance) {
+    uint32_t key = RESOURCE_INDEX_KEY(object_id, instance_id);
+
+    if (_count == _capacity) {
+        uint32_t capacity = _capacity ? _capacity * 2 : 8;
+        entry *entries = new (std::nothrow) entry[capacity];
+        if (!entries) {
+            // A partial index would hide objects, so drop it and let callers scan the list
+            clear();
+            _valid = false;
+            return false;
+        }
+        if (_count) {
+            memcpy(entries, _entries, _count * sizeof(entry));
+        }
+        delete[] _entries;
+        _entries = entries;
+        _capacity = capacity;
+    }
+
+    // Resources are usually registered in path order, so appending is the common case
+    uint32_t pos = (_count == 0 || _entries[_count - 1].key < key) ? _count : lower_bound(key);
+    if (pos < _count) {
+        memmove(&_entries[pos + 1], &_entries[pos], (_count - pos) * sizeof(entry));
+    }
+    _entries[pos].key = key;
+    _entries[pos].object = object;
+    _entries[pos].instance = instance;
+    _count++;
+
+    return true;
+}
 
 static void notification_delivery_status_cb_thunk(const M2MBase& base,
                                                   const NoticationDeliveryStatus status,
@@ -33,15 +125,25 @@ M2MResource* add_resource(M2MObjectList *list, uint16_t object_id, uint16_t inst
                           uint16_t resource_id, const char *resource_type, M2MResourceInstance::ResourceType data_type,
                           M2MBase::Operation allowed, const char *value, bool observable, Callback<void(const char*)> *put_cb,
                           Callback<void(void*)> *post_cb,
-                          Callback<void(const M2MBase&, const NoticationDeliveryStatus)> *notification_status_cb)
+                          Callback<void(const M2MBase&, const NoticationDeliveryStatus)> *notification_status_cb,
+                          ResourceIndex *index)
 {
     M2MObject *object = NULL;
     M2MObjectInstance* object_instance = NULL;
     M2MResource* resource = NULL;
     char name[6];
 
+    if (index && !index->valid()) {
+        index = NULL;
+    }
+
     //check if object already exists.
-    if (!list->empty()) {
+    if (index) {
+        object = index->find_object(object_id);
+        if (object) {
+            object_instance = index->find_instance(object_id, instance_id);
+        }
+    } else if (!list->empty()) {
         M2MObjectList::const_iterator it;
         it = list->begin();
         for ( ; it != list->end(); it++ ) {
@@ -56,13 +158,16 @@ M2MResource* add_resource(M2MObjectList *list, uint16_t object_id, uint16_t inst
         snprintf(name, 6, "%d", object_id);
         object = M2MInterfaceFactory::create_object(name);
         list->push_back(object);
-    } else {
+    } else if (!index) {
         //check if instance already exists.
         object_instance = object->object_instance(instance_id);
     }
     //Create new instance if needed.
     if (!object_instance) {
         object_instance = object->create_object_instance(instance_id);
+        if (index && !index->insert(object_id, instance_id, object, object_instance)) {
+            tr_warn("Resource index full, falling back to scanning the object list");
+        }
     }
     //create the recource.
     snprintf(name, 6, "%d", resource_id);
@@ -19,6 +19,65 @@
 #ifndef RESOURCE_H
 #define RESOURCE_H
 
+/**
+ * \brief Index of the objects and object instances created by add_resource,
+ *        sorted by object ID and instance ID.
+ *        Lookups are a binary search instead of a scan of the object list,
+ *        which keeps registering large resource trees linear.
+ *        The index only knows about objects created through add_resource,
+ *        so use it for every call on the same list.
+ */
+class ResourceIndex {
+public:
+    ResourceIndex();
+    ~ResourceIndex();
+
+    /**
+     * \brief Find an object by ID.
+     * \return The object, or NULL if it was not indexed.
+     */
+    M2MObject* find_object(uint16_t object_id) const;
+
+    /**
+     * \brief Find an object instance by object ID and instance ID.
+     * \return The object instance, or NULL if it was not indexed.
+     */
+    M2MObjectInstance* find_instance(uint16_t object_id, uint16_t instance_id) const;
+
+    /**
+     * \brief Add an object instance to the index.
+     * \return false if memory could not be allocated, the index is then
+     *         emptied and no longer valid().
+     */
+    bool insert(uint16_t object_id, uint16_t instance_id, M2MObject *object, M2MObjectInstance *instance);
+
+    /**
+     * \brief Whether the index holds every instance inserted since the last clear().
+     *        When false, look up objects in the object list instead.
+     */
+    bool valid() const;
+
+    /**
+     * \brief Remove all entries and free the index memory.
+     */
+    void clear();
+
+private:
+    struct entry {
+        uint32_t key;
+        M2MObject *object;
+        M2MObjectInstance *instance;
+    };
+
+    // Returns the position of the first entry with a key not less than key
+    uint32_t lower_bound(uint32_t key) const;
+
+    entry *_entries;
+    uint32_t _count;
+    uint32_t _capacity;
+    bool _valid;
+};
+
 
 /**
  * \brief Helper function for creating different kind of resources.
@@ -48,6 +107,8 @@
  *              at the same time.
  * \param notification_status_cb Function pointer to notification_delivery_status_cb
  *          if resource is set to be observable.
+ * \param index Optional index to look up existing objects and instances,
+ *          if NULL or no longer valid the object list is scanned.
  */
 M2MResource* add_resource(M2MObjectList *list,
                           uint16_t object_id,
@@ -60,6 +121,7 @@ M2MResource* add_resource(M2MObjectList *list,
                           bool observable,
                           Callback<void(const char*)> *put_cb,
                           Callback<void(void*)> *post_cb,
-                          Callback<void(const M2MBase&, const NoticationDeliveryStatus)> *notification_status_cb);
+                          Callback<void(const M2MBase&, const NoticationDeliveryStatus)> *notification_status_cb,
+                          ResourceIndex *index = NULL);
 
 #endif //RESOURCE_H
@@ -0,0 +1,174 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "resource-stream.h"
+#include "mbed_trace.h"
+
+#define TRACE_GROUP "SMCF"
+
+ResourceFileSink::ResourceFileSink(const char *path)
+    : _fs(NULL), _path(NULL), _open(false), _crc_value(0), _size(0)
+{
+    size_t len = strlen(path);
+    _path = new char[len + 1];
+    memcpy(_path, path, len + 1);
+}
+
+ResourceFileSink::~ResourceFileSink() {
+    if (_open) {
+        _file.close();
+    }
+    delete[] _path;
+}
+
+int ResourceFileSink::begin(FileSystem *fs) {
+    if (_open) {
+        abort();
+    }
+
+    // A failed begin must not report the previous payload
+    _size = 0;
+    _crc_value = 0;
+
+    _fs = fs;
+    if (!_fs) return -1;
+
+    int status = _file.open(_fs, _path, O_WRONLY | O_CREAT | O_TRUNC);
+    if (status != 0) {
+        tr_error("Could not open %s for writing (%d)", _path, status);
+        return status;
+    }
+
+    _open = true;
+    _crc.compute_partial_start(&_crc_value);
+    return 0;
+}
+
+int ResourceFileSink::write(const uint8_t *data, uint32_t length) {
+    if (!_open) return -1;
+
+    ssize_t written = _file.write(data, length);
+    if (written != (ssize_t)length) {
+        tr_error("Writing %s failed at offset %lu (%d)", _path, (unsigned long)_size, (int)written);
+        abort();
+        return written < 0 ? (int)written : -1;
+    }
+
+    _crc.compute_partial(data, length, &_crc_value);
+    _size += length;
+    return 0;
+}
+
+int ResourceFileSink::finish() {
+    if (!_open) return -1;
+
+    _open = false;
+    _crc.compute_partial_stop(&_crc_value);
+
+    int status = _file.close();
+    if (status != 0) {
+        tr_error("Closing %s failed (%d)", _path, status);
+    }
+    return status;
+}
+
+void ResourceFileSink::abort() {
+    if (!_open) return;
+
+    _open = false;
+    _file.close();
+    _fs->remove(_path);
+}
+
+bool ResourceFileSink::is_open() const {
+    return _open;
+}
+
+uint32_t ResourceFileSink::size() const {
+    return _size;
+}
+
+uint32_t ResourceFileSink::checksum() const {
+    return _crc_value;
+}
+
+ResourceFileSource::ResourceFileSource(const char *path, uint32_t max_read)
+    : _path(NULL), _offset(0), _max_read(max_read)
+{
+    size_t len = strlen(path);
+    _path = new char[len + 1];
+    memcpy(_path, path, len + 1);
+}
+
+ResourceFileSource::~ResourceFileSource() {
+    delete[] _path;
+}
+
+int ResourceFileSource::size(FileSystem *fs, size_t *size) {
+    if (!fs) return -1;
+
+    File file;
+    int status = file.open(fs, _path, O_RDONLY);
+    if (status != 0) {
+        tr_debug("Could not open %s for reading (%d)", _path, status);
+        return status;
+    }
+
+    off_t file_size = file.size();
+    file.close();
+
+    if (file_size < 0) return (int)file_size;
+
+    uint32_t remaining = (uint32_t)file_size > _offset ? (uint32_t)file_size - _offset : 0;
+    *size = remaining < _max_read ? remaining : _max_read;
+    return 0;
+}
+
+int ResourceFileSource::read(FileSystem *fs, void *buffer, size_t *length) {
+    if (!fs) return -1;
+
+    File file;
+    int status = file.open(fs, _path, O_RDONLY);
+    if (status != 0) {
+        tr_debug("Could not open %s for reading (%d)", _path, status);
+        return status;
+    }
+
+    size_t to_read = *length < _max_read ? *length : _max_read;
+    ssize_t read = 0;
+    if (file.seek(_offset, SEEK_SET) == (off_t)_offset) {
+        read = file.read(buffer, to_read);
+    }
+    file.close();
+
+    if (read < 0) {
+        tr_error("Reading %s failed at offset %lu (%d)", _path, (unsigned long)_offset, (int)read);
+        return (int)read;
+    }
+
+    *length = read;
+    return 0;
+}
+
+void ResourceFileSource::set_offset(uint32_t offset) {
+    _offset = offset;
+}
+
+uint32_t ResourceFileSource::offset() const {
+    return _offset;
+}
@@ -0,0 +1,144 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef RESOURCE_STREAM_H
+#define RESOURCE_STREAM_H
+
+#include "mbed.h"
+#include "FileSystem.h"
+
+/**
+ * Writes an incoming payload to a file as it arrives, one block at a time,
+ * and keeps a CRC-32 of everything written.
+ */
+class ResourceFileSink {
+public:
+    /**
+     * @param path Path of the file, copied
+     */
+    ResourceFileSink(const char *path);
+
+    ~ResourceFileSink();
+
+    /**
+     * Create or truncate the file and reset the checksum
+     *
+     * @param fs File system to write to
+     *
+     * @returns 0 if successful, negative error code if not
+     */
+    int begin(FileSystem *fs);
+
+    /**
+     * Append data to the file
+     *
+     * @returns 0 if successful, negative error code if not
+     */
+    int write(const uint8_t *data, uint32_t length);
+
+    /**
+     * Close the file and finalize the checksum
+     *
+     * @returns 0 if successful, negative error code if not
+     */
+    int finish();
+
+    /**
+     * Close and remove a partially written file
+     */
+    void abort();
+
+    /**
+     * Whether a payload is being written
+     */
+    bool is_open() const;
+
+    /**
+     * Number of bytes written since 'begin'
+     */
+    uint32_t size() const;
+
+    /**
+     * CRC-32 (ANSI) of the data written, valid after 'finish'
+     */
+    uint32_t checksum() const;
+
+private:
+    FileSystem *_fs;
+    char *_path;
+    File _file;
+    bool _open;
+    MbedCRC<POLY_32BIT_ANSI, 32> _crc;
+    uint32_t _crc_value;
+    uint32_t _size;
+};
+
+/**
+ * Serves a window of a file as a resource value, reading it from the file
+ * system on every request instead of keeping it in memory.
+ * The window starts at a movable offset and is at most max_read bytes,
+ * so the memory needed to serve it does not depend on the file size.
+ */
+class ResourceFileSource {
+public:
+    /**
+     * @param path Path of the file, copied
+     * @param max_read Maximum number of bytes served per request
+     */
+    ResourceFileSource(const char *path, uint32_t max_read);
+
+    ~ResourceFileSource();
+
+    /**
+     * Get the number of bytes the next read returns
+     *
+     * @param fs File system to read from
+     * @param size Receives the size of the window
+     *
+     * @returns 0 if successful, negative error code if not
+     */
+    int size(FileSystem *fs, size_t *size);
+
+    /**
+     * Read the window into a buffer
+     *
+     * @param fs File system to read from
+     * @param buffer Buffer to read into
+     * @param length Size of the buffer, receives the number of bytes read
+     *
+     * @returns 0 if successful, negative error code if not
+     */
+    int read(FileSystem *fs, void *buffer, size_t *length);
+
+    /**
+     * Move the start of the window
+     */
+    void set_offset(uint32_t offset);
+
+    /**
+     * Start of the window
+     */
+    uint32_t offset() const;
+
+private:
+    char *_path;
+    uint32_t _offset;
+    uint32_t _max_read;
+};
+
+#endif // RESOURCE_STREAM_H
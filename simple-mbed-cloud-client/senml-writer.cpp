@@ -0,0 +1,158 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "senml-writer.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// SenML CBOR labels, RFC 8428 section 6
+#define SENML_LABEL_BASE_NAME   -2
+#define SENML_LABEL_BASE_TIME   -3
+#define SENML_LABEL_VALUE        2
+#define SENML_LABEL_TIME         6
+
+#define CBOR_MAJOR_UNSIGNED      0
+#define CBOR_MAJOR_NEGATIVE      1
+#define CBOR_MAJOR_TEXT          3
+#define CBOR_MAJOR_ARRAY         4
+#define CBOR_MAJOR_MAP           5
+#define CBOR_FLOAT32             0xfa
+
+SenmlWriter::SenmlWriter(Format format, uint8_t *buffer, size_t size)
+    : _format(format), _buffer(buffer), _size(size), _length(0), _overflow(false), _first(true)
+{
+}
+
+void SenmlWriter::begin(uint32_t count) {
+    _length = 0;
+    _overflow = false;
+    _first = true;
+
+    if (_format == CBOR) {
+        put_cbor_head(CBOR_MAJOR_ARRAY, count);
+    } else {
+        put('[');
+    }
+}
+
+void SenmlWriter::add(const char *base_name, int64_t base_time, float time, float value) {
+    if (_format == CBOR) {
+        put_cbor_head(CBOR_MAJOR_MAP, 2 + (base_name ? 1 : 0) + (base_time ? 1 : 0));
+        if (base_name) {
+            size_t len = strlen(base_name);
+            put_cbor_int(SENML_LABEL_BASE_NAME);
+            put_cbor_head(CBOR_MAJOR_TEXT, len);
+            for (size_t i = 0; i < len; i++) {
+                put(base_name[i]);
+            }
+        }
+        if (base_time) {
+            put_cbor_int(SENML_LABEL_BASE_TIME);
+            put_cbor_int(base_time);
+        }
+        put_cbor_int(SENML_LABEL_TIME);
+        put_cbor_float(time);
+        put_cbor_int(SENML_LABEL_VALUE);
+        put_cbor_float(value);
+    } else {
+        put_json("%s{", _first ? "" : ",");
+        if (base_name) {
+            put_json("\"bn\":\"%s\",", base_name);
+        }
+        if (base_time) {
+            put_json("\"bt\":%ld,", (long)base_time);
+        }
+        put_json("\"t\":%g,\"v\":%g}", time, value);
+    }
+
+    _first = false;
+}
+
+size_t SenmlWriter::end() {
+    if (_format == JSON) {
+        put(']');
+    }
+
+    return _overflow ? 0 : _length;
+}
+
+void SenmlWriter::put(uint8_t byte) {
+    if (_length >= _size) {
+        _overflow = true;
+        return;
+    }
+    _buffer[_length++] = byte;
+}
+
+void SenmlWriter::put_cbor_head(uint8_t major, uint64_t value) {
+    major <<= 5;
+    if (value < 24) {
+        put(major | (uint8_t)value);
+    } else if (value <= 0xff) {
+        put(major | 24);
+        put((uint8_t)value);
+    } else if (value <= 0xffff) {
+        put(major | 25);
+        put((uint8_t)(value >> 8));
+        put((uint8_t)value);
+    } else if (value <= 0xffffffffUL) {
+        put(major | 26);
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            put((uint8_t)(value >> shift));
+        }
+    } else {
+        put(major | 27);
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            put((uint8_t)(value >> shift));
+        }
+    }
+}
+
+void SenmlWriter::put_cbor_int(int64_t value) {
+    if (value < 0) {
+        put_cbor_head(CBOR_MAJOR_NEGATIVE, (uint64_t)(-(value + 1)));
+    } else {
+        put_cbor_head(CBOR_MAJOR_UNSIGNED, (uint64_t)value);
+    }
+}
+
+void SenmlWriter::put_cbor_float(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    put(CBOR_FLOAT32);
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        put((uint8_t)(bits >> shift));
+    }
+}
+
+void SenmlWriter::put_json(const char *format, ...) {
+    if (_overflow) return;
+
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf((char*)_buffer + _length, _size - _length, format, args);
+    va_end(args);
+
+    if (len < 0 || (size_t)len >= _size - _length) {
+        _overflow = true;
+        return;
+    }
+    _length += len;
+}
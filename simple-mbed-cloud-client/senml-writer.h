@@ -0,0 +1,85 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef SENML_WRITER_H
+#define SENML_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Writes a SenML pack (RFC 8428) of numeric records into a caller supplied buffer,
+ * either as CBOR or as JSON. Only the fields needed for a time series are supported:
+ * base name, base time, time and value.
+ *
+ * This class does not allocate memory and does not depend on Mbed OS.
+ */
+class SenmlWriter {
+public:
+    enum Format {
+        CBOR,
+        JSON
+    };
+
+    /**
+     * @param format Encoding of the pack
+     * @param buffer Buffer to write into
+     * @param size Size of the buffer
+     */
+    SenmlWriter(Format format, uint8_t *buffer, size_t size);
+
+    /**
+     * Start the pack
+     *
+     * @param count Number of records that will be added
+     */
+    void begin(uint32_t count);
+
+    /**
+     * Add a record
+     *
+     * @param base_name Base name, or NULL to leave it out
+     * @param base_time Base time in seconds, or 0 to leave it out
+     * @param time Time in seconds, relative to the base time (or to now without a base time)
+     * @param value Numeric value
+     */
+    void add(const char *base_name, int64_t base_time, float time, float value);
+
+    /**
+     * Finish the pack
+     *
+     * @returns Length of the pack in bytes, 0 if it did not fit in the buffer
+     */
+    size_t end();
+
+private:
+    void put(uint8_t byte);
+    void put_cbor_head(uint8_t major, uint64_t value);
+    void put_cbor_int(int64_t value);
+    void put_cbor_float(float value);
+    void put_json(const char *format, ...);
+
+    Format _format;
+    uint8_t *_buffer;
+    size_t _size;
+    size_t _length;
+    bool _overflow;
+    bool _first;
+};
+
+#endif // SENML_WRITER_H
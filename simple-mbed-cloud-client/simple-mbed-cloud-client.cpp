@@ -39,176 +39,1048 @@
 #include "memory_tests.h"
 #endif
 
+#if MBED_CONF_NSAPI_SOCKET_STATS_ENABLED
+#include "SocketStats.h"
+#endif
+
 #ifndef DEFAULT_FIRMWARE_PATH
 #define DEFAULT_FIRMWARE_PATH       "/fs/firmware"
 #endif
 
+#if MBED_CONF_DEVICE_MANAGEMENT_VERIFIED_CONFIG_CACHE == 1
+#include "key_config_manager.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/platform_util.h"
+
+#define VERIFIED_CONFIG_FILE        "smcc_verified"
+#define VERIFIED_CONFIG_DIGEST_SIZE 32
+
+// A build time does not change when only this file is not rebuilt, so the version must be explicit
+#if !defined(MBED_CONF_DEVICE_MANAGEMENT_FIRMWARE_VERSION)
+#error "device-management.verified-config-cache requires device-management.firmware-version to be set"
+#endif
+#define VERIFIED_CONFIG_VERSION     MBED_CONF_DEVICE_MANAGEMENT_FIRMWARE_VERSION
+
+// Items read by fcc_verify_device_configured_4mbed_cloud(), a change in any of them invalidates the cache
+static const struct {
+    const char *name;
+    kcm_item_type_e type;
+} verified_config_items[] = {
+    { g_fcc_use_bootstrap_parameter_name,           KCM_CONFIG_ITEM },
+    { g_fcc_endpoint_parameter_name,                KCM_CONFIG_ITEM },
+    { g_fcc_bootstrap_server_uri_name,              KCM_CONFIG_ITEM },
+    { g_fcc_bootstrap_server_ca_certificate_name,   KCM_CERTIFICATE_ITEM },
+    { g_fcc_bootstrap_device_certificate_name,      KCM_CERTIFICATE_ITEM },
+    { g_fcc_bootstrap_device_private_key_name,      KCM_PRIVATE_KEY_ITEM },
+    { g_fcc_lwm2m_server_uri_name,                  KCM_CONFIG_ITEM },
+    { g_fcc_lwm2m_server_ca_certificate_name,       KCM_CERTIFICATE_ITEM },
+    { g_fcc_lwm2m_device_certificate_name,          KCM_CERTIFICATE_ITEM },
+    { g_fcc_lwm2m_device_private_key_name,          KCM_PRIVATE_KEY_ITEM },
+};
+#endif
+
+#ifndef MBED_CONF_DEVICE_MANAGEMENT_OFFLINE_QUEUE_FILE
+#define MBED_CONF_DEVICE_MANAGEMENT_OFFLINE_QUEUE_FILE "smcc_queue"
+#endif
+
+#ifndef MBED_CONF_DEVICE_MANAGEMENT_OFFLINE_QUEUE_SYNC_INTERVAL
+#define MBED_CONF_DEVICE_MANAGEMENT_OFFLINE_QUEUE_SYNC_INTERVAL 8
+#endif
+
+#ifndef MBED_CONF_DEVICE_MANAGEMENT_NOTIFICATION_MAX_IN_FLIGHT
+#define MBED_CONF_DEVICE_MANAGEMENT_NOTIFICATION_MAX_IN_FLIGHT 0
+#endif
+
+#ifndef MBED_CONF_DEVICE_MANAGEMENT_NOTIFICATION_MAX_PENDING
+#define MBED_CONF_DEVICE_MANAGEMENT_NOTIFICATION_MAX_PENDING 16
+#endif
+
+#ifndef MBED_CONF_DEVICE_MANAGEMENT_NOTIFICATION_IN_FLIGHT_TIMEOUT_MS
+#define MBED_CONF_DEVICE_MANAGEMENT_NOTIFICATION_IN_FLIGHT_TIMEOUT_MS 60000
+#endif
+
+#ifndef MBED_CONF_DEVICE_MANAGEMENT_REGISTER_UPDATE_WINDOW_MS
+#define MBED_CONF_DEVICE_MANAGEMENT_REGISTER_UPDATE_WINDOW_MS 0
+#endif
+
+#ifndef MBED_CONF_DEVICE_MANAGEMENT_DNS_CACHE_FILE
+#define MBED_CONF_DEVICE_MANAGEMENT_DNS_CACHE_FILE "smcc_dns"
+#endif
+
+#ifndef MBED_CONF_DEVICE_MANAGEMENT_KEEPALIVE_FILE
+#define MBED_CONF_DEVICE_MANAGEMENT_KEEPALIVE_FILE "smcc_keepalive"
+#endif
+
+// Networks whose keep-alive search is kept, the least recently used is replaced
+#define KEEPALIVE_NETWORKS          4
+
+// Time a failover switch waits for the closed client to report it unregistered.
+// A client that was not registered may never report it.
+#define FAILOVER_CLOSE_TIMEOUT_MS   5000
+
+struct keepalive_record {
+    uint32_t network;
+    uint32_t good_ms;
+    uint32_t bad_ms;
+};
+
+#ifndef MBED_CONF_DEVICE_MANAGEMENT_WAKE_WINDOW_PERIOD_MS
+#define MBED_CONF_DEVICE_MANAGEMENT_WAKE_WINDOW_PERIOD_MS 0
+#endif
+
+#ifndef MBED_CONF_DEVICE_MANAGEMENT_DIAGNOSTICS_PERIOD_MS
+#define MBED_CONF_DEVICE_MANAGEMENT_DIAGNOSTICS_PERIOD_MS 60000
+#endif
+
+#ifndef MBED_CONF_DEVICE_MANAGEMENT_DAPLINK_WAIT_MS
+#define MBED_CONF_DEVICE_MANAGEMENT_DAPLINK_WAIT_MS 0
+#endif
+
+// Errors after which the client is not registered, and registering again may succeed
+static bool is_connection_error(int error_code) {
+    switch (error_code) {
+        case MbedCloudClient::ConnectBootstrapFailed:
+        case MbedCloudClient::ConnectTimeout:
+        case MbedCloudClient::ConnectNetworkError:
+        case MbedCloudClient::ConnectUnknownError:
+        case MbedCloudClient::ConnectSecureConnectionFailed:
+        case MbedCloudClient::ConnectDnsResolvingFailed:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Registration updates must come before the registration expires
+static uint32_t cap_to_lifetime(uint32_t period_ms) {
+#ifdef MBED_CLOUD_CLIENT_LIFETIME
+    uint32_t max_period_ms = (uint32_t)MBED_CLOUD_CLIENT_LIFETIME * 750;
+#else
+    uint32_t max_period_ms = 3600 * 750;
+#endif
+    return period_ms < max_period_ms ? period_ms : max_period_ms;
+}
+
+// FNV-1a, continuing from hash
+static uint32_t hash_string(uint32_t hash, const char *str) {
+    while (str && *str) {
+        hash = (hash ^ (uint8_t)*str++) * 16777619UL;
+    }
+    // Separate the strings, so "a" "bc" differs from "ab" "c"
+    return (hash ^ 0xff) * 16777619UL;
+}
+
+// Identifies the network the interface is attached to, for the learnt keep-alive.
+// Mbed OS does not expose the SSID or operator, so the interface itself is part of the key.
+static uint32_t network_key(NetworkInterface *net) {
+    uint32_t hash = 2166136261UL;
+    hash = hash_string(hash, net->get_gateway());
+    hash = hash_string(hash, net->get_netmask());
+    hash = hash_string(hash, net->get_mac_address());
+    return hash;
+}
+
+// Returns the time since *start and moves *start to now
+static uint32_t lap_ms(uint64_t *start) {
+    uint64_t now = Kernel::get_ms_count();
+    uint32_t elapsed = (uint32_t)(now - *start);
+    *start = now;
+    return elapsed;
+}
+
 SimpleMbedCloudClient::SimpleMbedCloudClient(NetworkInterface *net, BlockDevice *bd, FileSystem *fs) :
-    _registered(false),
+    _last_error(0),
     _register_called(false),
     _register_and_connect_called(false),
+    _batch_thread(NULL),
+    _drain_scheduled(0),
+    _resources(NULL),
+    _resources_tail(NULL),
     _registered_cb(NULL),
     _unregistered_cb(NULL),
     _error_cb(NULL),
     _net(net),
     _bd(bd),
     _fs(fs),
-    _storage(bd, fs)
+    _storage(bd, fs),
+    _init_start_ms(0),
+    _register_start_ms(0),
+    _timing_resource(NULL),
+    _reconnect_enabled(false),
+    _closing(false),
+    _reconnect_event(0),
+    _update_event(0),
+    _dns(MBED_CONF_DEVICE_MANAGEMENT_DNS_CACHE_FILE),
+    _dns_enabled(false),
+    _failover_enabled(false),
+    _failover_event(0),
+    _failover_switch_to(-1),
+    _failover_close_event(0),
+    _keepalive_enabled(false),
+    _keepalive_event(0),
+    _keepalive_network(0),
+    _keepalive_interval_ms(0),
+    _keepalive_probe_ms(0),
+    _keepalive_traffic(0),
+    _wake_event(0),
+    _offline_queue(MBED_CONF_DEVICE_MANAGEMENT_OFFLINE_QUEUE_FILE),
+    _offline_queue_capacity(0),
+    _offline_queue_overflow(MCC_QUEUE_DROP_OLDEST),
+    _offline_drain_interval_ms(100),
+    _offline_drain_event(0),
+    _queued_value_cb(NULL),
+    _send_scheduled(0),
+    _notification_expiry_event(0),
+    _diagnostics_event(0),
+    _init_running(false),
+    _init_step(MCC_INIT_DONE),
+    _init_format(false),
+    _init_storage_reset(false),
+    _init_verify_retry(false),
+    _init_queue(NULL),
+    _init_done_cb(NULL),
+    _init_progress_cb(NULL)
 {
+    memset(&_timing, 0, sizeof(_timing));
+    memset(&_diagnostics, 0, sizeof(_diagnostics));
+    memset(_diagnostics_resources, 0, sizeof(_diagnostics_resources));
+    memset(_networks, 0, sizeof(_networks));
+    _networks[_failover.add()] = net;
+    _update_debouncer.configure(MBED_CONF_DEVICE_MANAGEMENT_REGISTER_UPDATE_WINDOW_MS);
+    _wake.configure(cap_to_lifetime(MBED_CONF_DEVICE_MANAGEMENT_WAKE_WINDOW_PERIOD_MS));
+    _notifications.configure(MBED_CONF_DEVICE_MANAGEMENT_NOTIFICATION_MAX_IN_FLIGHT,
+                             MBED_CONF_DEVICE_MANAGEMENT_NOTIFICATION_MAX_PENDING);
 }
 
 SimpleMbedCloudClient::~SimpleMbedCloudClient() {
-    for (int i = 0; i < _resources.size(); i++) {
-        delete _resources[i];
+    if (_diagnostics_event) {
+        mbed_event_queue()->cancel(_diagnostics_event);
+    }
+    if (_notification_expiry_event) {
+        mbed_event_queue()->cancel(_notification_expiry_event);
+    }
+    disable_failover();
+
+    MbedCloudClientResource *resource = _resources;
+    while (resource) {
+        MbedCloudClientResource *next = resource->next;
+        if (resource->managed) {
+            delete resource;
+        }
+        resource = next;
     }
 }
 
 int SimpleMbedCloudClient::init(bool format) {
+    if (_init_running) return 1;
+
+#if MBED_CONF_DEVICE_MANAGEMENT_DAPLINK_WAIT_MS > 0
     // Requires DAPLink 245+ (https://github.com/ARMmbed/DAPLink/pull/364)
     // Older versions: workaround to prevent possible deletion of credentials:
-    wait(1);
+    wait_ms(MBED_CONF_DEVICE_MANAGEMENT_DAPLINK_WAIT_MS);
+#endif
 
-#ifdef MBED_CLOUD_DEV_UPDATE_ID
+    init_start(format);
+    while (_init_step != MCC_INIT_DONE) {
+        int status = init_step();
+        if (status != 0) {
+            _init_running = false;
+            return status;
+        }
+    }
+    _init_running = false;
 
-    extern const uint8_t arm_uc_vendor_id[];
-    extern const uint16_t arm_uc_vendor_id_size;
-    extern const uint8_t arm_uc_class_id[];
-    extern const uint16_t arm_uc_class_id_size;
+    return 0;
+}
 
-    ARM_UC_SetVendorId(arm_uc_vendor_id, arm_uc_vendor_id_size);
-    ARM_UC_SetClassId(arm_uc_class_id, arm_uc_class_id_size);
+int SimpleMbedCloudClient::init_async(Callback<void(int)> done_cb, Callback<void(mcc_init_step)> progress_cb,
+                                      bool format, EventQueue *queue) {
+    if (_init_running) return 1;
 
-#endif
+    _init_queue = queue ? queue : mbed_event_queue();
+    _init_done_cb = done_cb;
+    _init_progress_cb = progress_cb;
 
-    // Initialize Mbed Trace for debugging
-    // Create mutex for tracing to avoid broken lines in logs
-    if(!mbed_trace_helper_create_mutex()) {
-        printf("[SMCC] ERROR - Mutex creation for mbed_trace failed!\n");
+    init_start(format);
+
+#if MBED_CONF_DEVICE_MANAGEMENT_DAPLINK_WAIT_MS > 0
+    // Requires DAPLink 245+ (https://github.com/ARMmbed/DAPLink/pull/364)
+    // Older versions: workaround to prevent possible deletion of credentials:
+    int event = _init_queue->call_in(MBED_CONF_DEVICE_MANAGEMENT_DAPLINK_WAIT_MS, callback(this, &SimpleMbedCloudClient::init_async_step));
+#else
+    int event = _init_queue->call(callback(this, &SimpleMbedCloudClient::init_async_step));
+#endif
+    if (event == 0) {
+        tr_error("Could not schedule init");
+        _init_running = false;
         return 1;
     }
 
-    // Initialize mbed trace
-    mbed_trace_init();
-    mbed_trace_helper_create_mutex();
-    mbed_trace_mutex_wait_function_set(mbed_trace_helper_mutex_wait);
-    mbed_trace_mutex_release_function_set(mbed_trace_helper_mutex_release);
+    return 0;
+}
+
+void SimpleMbedCloudClient::init_async_step() {
+    mcc_init_step step = _init_step;
+    int status = init_step();
 
-    // Initialize the FCC
-    int status = fcc_init();
-    if (status != FCC_STATUS_SUCCESS && status != FCC_STATUS_ENTROPY_ERROR && status != FCC_STATUS_ROT_ERROR) {
-        tr_error("Factory Client Configuration failed with status %d", status);
-        return 1;
+    if (status != 0) {
+        _init_running = false;
+        if (_init_done_cb) {
+            _init_done_cb(status);
+        }
+        return;
     }
 
-    status = _storage.init();
-    if (status != FCC_STATUS_SUCCESS) {
-        tr_error("Failed to initialize storage layer (%d)", status);
-        return 1;
+    if (_init_progress_cb) {
+        _init_progress_cb(step);
     }
 
-    status = _storage.sotp_init();
-    if (status != FCC_STATUS_SUCCESS) {
-        tr_error("Could not initialize SOTP (%d)", status);
-        fcc_finalize();
-        return 1;
+    if (_init_step == MCC_INIT_DONE) {
+        _init_running = false;
+        if (_init_done_cb) {
+            _init_done_cb(0);
+        }
+        return;
+    }
+
+    // Yield between the steps, so other events on the queue can run
+    if (_init_queue->call(callback(this, &SimpleMbedCloudClient::init_async_step)) == 0) {
+        tr_error("Could not schedule the next init step");
+        _init_running = false;
+        if (_init_done_cb) {
+            _init_done_cb(1);
+        }
     }
+}
+
+void SimpleMbedCloudClient::init_start(bool format) {
+    _init_running = true;
+    _init_step = MCC_INIT_TRACE;
+    _init_format = format;
+    _init_storage_reset = false;
+    _init_verify_retry = false;
+
+    memset(&_timing, 0, sizeof(_timing));
+    _init_start_ms = Kernel::get_ms_count();
+}
+
+int SimpleMbedCloudClient::init_step() {
+    uint64_t phase_start = Kernel::get_ms_count();
+    int status = 0;
 
+    switch (_init_step) {
+        case MCC_INIT_TRACE:
+#ifdef MBED_CLOUD_DEV_UPDATE_ID
+        {
+            extern const uint8_t arm_uc_vendor_id[];
+            extern const uint16_t arm_uc_vendor_id_size;
+            extern const uint8_t arm_uc_class_id[];
+            extern const uint16_t arm_uc_class_id_size;
+
+            ARM_UC_SetVendorId(arm_uc_vendor_id, arm_uc_vendor_id_size);
+            ARM_UC_SetClassId(arm_uc_class_id, arm_uc_class_id_size);
+        }
+#endif
+
+            // Initialize Mbed Trace for debugging
+            // Create mutex for tracing to avoid broken lines in logs
+            if(!mbed_trace_helper_create_mutex()) {
+                printf("[SMCC] ERROR - Mutex creation for mbed_trace failed!\n");
+                return 1;
+            }
+
+            // Initialize mbed trace
+            mbed_trace_init();
+            mbed_trace_helper_create_mutex();
+            mbed_trace_mutex_wait_function_set(mbed_trace_helper_mutex_wait);
+            mbed_trace_mutex_release_function_set(mbed_trace_helper_mutex_release);
+
+            _timing.trace_ms += lap_ms(&phase_start);
+            _init_step = MCC_INIT_FCC;
+            break;
+
+        case MCC_INIT_FCC:
+            // Initialize the FCC
+            status = fcc_init();
+            _timing.fcc_ms += lap_ms(&phase_start);
+            if (status != FCC_STATUS_SUCCESS && status != FCC_STATUS_ENTROPY_ERROR && status != FCC_STATUS_ROT_ERROR) {
+                tr_error("Factory Client Configuration failed with status %d", status);
+                return 1;
+            }
+            _init_step = MCC_INIT_STORAGE;
+            break;
+
+        case MCC_INIT_STORAGE:
+            status = _storage.init();
+            _timing.storage_ms += lap_ms(&phase_start);
+            if (status != FCC_STATUS_SUCCESS) {
+                tr_error("Failed to initialize storage layer (%d)", status);
+                return 1;
+            }
+            _init_step = MCC_INIT_SOTP;
+            break;
+
+        case MCC_INIT_SOTP:
+            status = _storage.sotp_init();
+            _timing.sotp_ms += lap_ms(&phase_start);
+            if (status != FCC_STATUS_SUCCESS) {
+                tr_error("Could not initialize SOTP (%d)", status);
+                if (_init_verify_retry) {
+                    return status;
+                }
+                if (!_init_storage_reset) {
+                    fcc_finalize();
+                }
+                return 1;
+            }
 #if RESET_STORAGE
-    status = reset_storage();
-    if (status != FCC_STATUS_SUCCESS) {
-        tr_error("reset_storage (triggered by RESET_STORAGE macro) failed (%d)", status);
-        return 1;
+            if (!_init_storage_reset) {
+                _init_step = MCC_INIT_RESET_STORAGE;
+                break;
+            }
+#endif
+            _init_step = MCC_INIT_VERIFY;
+            break;
+
+        case MCC_INIT_RESET_STORAGE:
+            status = reset_storage();
+            _timing.storage_ms += lap_ms(&phase_start);
+            if (status != FCC_STATUS_SUCCESS) {
+                if (_init_verify_retry) {
+                    return status;
+                }
+                tr_error("reset_storage (triggered by RESET_STORAGE macro) failed (%d)", status);
+                return 1;
+            }
+            _init_storage_reset = true;
+            // Reinitialize SOTP
+            _init_step = MCC_INIT_SOTP;
+            break;
+
+        case MCC_INIT_VERIFY:
+            status = verify_cloud_configuration(_init_format);
+            _timing.verify_ms += lap_ms(&phase_start);
+            if (status != 0) {
+                if (_init_verify_retry) {
+                    return status;
+                }
+            // This is designed to simplify user-experience by auto-formatting the
+            // primary storage if no valid certificates exist.
+            // This should never be used for any kind of production devices.
+#if MBED_CONF_APP_FORMAT_STORAGE_LAYER_ON_ERROR == 1
+                tr_info("Could not load certificate (e.g. no certificates or RoT might have changed), resetting storage...");
+                _init_verify_retry = true;
+                _init_step = MCC_INIT_RESET_STORAGE;
+                break;
+#else
+                return 1;
+#endif
+            }
+
+            tr_info("Startup: trace %lu ms, fcc %lu ms, storage %lu ms, sotp %lu ms, verify %lu ms%s",
+                    (unsigned long)_timing.trace_ms, (unsigned long)_timing.fcc_ms, (unsigned long)_timing.storage_ms,
+                    (unsigned long)_timing.sotp_ms, (unsigned long)_timing.verify_ms,
+                    _timing.verify_cached ? " (cached)" : "");
+#ifdef RESET_FIRMWARE
+            _init_step = MCC_INIT_ERASE_FIRMWARE;
+#else
+            _init_step = MCC_INIT_DONE;
+#endif
+            break;
+
+        case MCC_INIT_ERASE_FIRMWARE:
+        {
+            // Deletes existing firmware images from storage.
+            // This deletes any existing firmware images during application startup.
+            // This compilation flag is currently implemented only for mbed OS.
+            palStatus_t pal_status = pal_fsRmFiles(DEFAULT_FIRMWARE_PATH);
+            if(pal_status == PAL_SUCCESS) {
+                printf("[SMCC] Firmware storage erased\n");
+            } else if (pal_status == PAL_ERR_FS_NO_PATH) {
+                tr_info("Firmware path not found/does not exist");
+            } else {
+                tr_error("Firmware storage erasing failed with %" PRId32, pal_status);
+                return 1;
+            }
+            _init_step = MCC_INIT_DONE;
+            break;
+        }
+
+        case MCC_INIT_DONE:
+            break;
     }
-    // Reinitialize SOTP
-    status = _storage.sotp_init();
-    if (status != FCC_STATUS_SUCCESS) {
-        tr_error("Could not initialize SOTP (%d)", status);
-        return 1;
+
+    return 0;
+}
+
+bool SimpleMbedCloudClient::call_register() {
+    // need to unregister first before calling this function again
+    if (_register_called) return false;
+
+    _cloud_client.on_registered(this, &SimpleMbedCloudClient::client_registered);
+    _cloud_client.on_unregistered(this, &SimpleMbedCloudClient::client_unregistered);
+    _cloud_client.on_error(this, &SimpleMbedCloudClient::error);
+    _cloud_client.on_registration_updated(this, &SimpleMbedCloudClient::client_registration_updated);
+    _cloud_client.set_queue_sleep_handler(callback(this, &SimpleMbedCloudClient::client_sleeping));
+
+    _closing = false;
+    _register_start_ms = Kernel::get_ms_count();
+
+    // Host name lookups of the client go through the cache
+    NetworkInterface *net = _net;
+    if (_dns_enabled) {
+        _dns.set_interface(_net);
+        net = &_dns;
     }
+
+    bool setup = _cloud_client.setup(net);
+    _register_called = true;
+    if (!setup) {
+        tr_error("Client setup failed");
+        return false;
+    }
+
+#ifdef MBED_CLOUD_CLIENT_SUPPORT_UPDATE
+    /* Set callback functions for authorizing updates and monitoring progress.
+       Code is implemented in update_ui_example.cpp
+       Both callbacks are completely optional. If no authorization callback
+       is set, the update process will procede immediately in each step.
+    */
+    update_helper_set_cloud_client(&_cloud_client);
+    _cloud_client.set_update_authorize_handler(update_authorize);
+    _cloud_client.set_update_progress_handler(update_progress);
 #endif
+    return true;
+}
 
-    status = verify_cloud_configuration(format);
+void SimpleMbedCloudClient::close() {
+    _closing = true;
+    _cloud_client.close();
+}
 
-    if (status != 0) {
-    // This is designed to simplify user-experience by auto-formatting the
-    // primary storage if no valid certificates exist.
-    // This should never be used for any kind of production devices.
-#if MBED_CONF_APP_FORMAT_STORAGE_LAYER_ON_ERROR == 1
-        tr_info("Could not load certificate (e.g. no certificates or RoT might have changed), resetting storage...");
-        status = reset_storage();
-        if (status != FCC_STATUS_SUCCESS) {
-            return status;
+void SimpleMbedCloudClient::enable_reconnect(uint32_t base_delay_ms, uint32_t max_delay_ms,
+                                             uint32_t retry_budget, uint32_t link_up_jitter_ms) {
+    _reconnect.configure(base_delay_ms, max_delay_ms, retry_budget, link_up_jitter_ms);
+
+    // Devices should not share a sequence, so mix the MAC address into the seed
+    uint32_t seed = (uint32_t)Kernel::get_ms_count();
+    const char *mac = _net->get_mac_address();
+    while (mac && *mac) {
+        seed = seed * 31 + *mac++;
+    }
+    _reconnect.seed(seed);
+
+    _reconnect_enabled = true;
+    _net->attach(callback(this, &SimpleMbedCloudClient::network_status_changed));
+}
+
+void SimpleMbedCloudClient::disable_reconnect() {
+    _reconnect_enabled = false;
+    if (_reconnect_event) {
+        mbed_event_queue()->cancel(_reconnect_event);
+        _reconnect_event = 0;
+    }
+}
+
+uint32_t SimpleMbedCloudClient::get_reconnect_attempts() {
+    return _reconnect.attempts();
+}
+
+void SimpleMbedCloudClient::reconnect_needed() {
+    if (!_reconnect_enabled || _closing || is_client_registered()) return;
+
+    if (!_reconnect.on_failure(Kernel::get_ms_count())) {
+        if (_reconnect.exhausted()) {
+            tr_warn("Reconnect budget exhausted after %lu attempts", (unsigned long)_reconnect.attempts());
         }
-        status = _storage.sotp_init();
-        if (status != FCC_STATUS_SUCCESS) {
-            return status;
+    }
+    schedule_reconnect();
+}
+
+void SimpleMbedCloudClient::reconnect_succeeded() {
+    _reconnect.on_success();
+    schedule_reconnect();
+}
+
+void SimpleMbedCloudClient::reconnect_attempt() {
+    _reconnect_event = 0;
+    if (!_reconnect_enabled || _closing || is_client_registered()) return;
+
+    _reconnect.on_attempt();
+    core_util_atomic_incr_u32(&_diagnostics.reconnects, 1);
+    tr_info("Reconnect attempt %lu", (unsigned long)_reconnect.attempts());
+
+    _register_called = false;
+    if (!call_register()) {
+        reconnect_needed();
+    }
+}
+
+void SimpleMbedCloudClient::schedule_reconnect() {
+    if (_reconnect_event) {
+        mbed_event_queue()->cancel(_reconnect_event);
+        _reconnect_event = 0;
+    }
+
+    if (!_reconnect.pending()) return;
+
+    uint64_t now = Kernel::get_ms_count();
+    uint64_t at = _reconnect.next_attempt_ms();
+    int delay = at > now ? (int)(at - now) : 0;
+    _reconnect_event = mbed_event_queue()->call_in(delay, callback(this, &SimpleMbedCloudClient::reconnect_attempt));
+}
+
+void SimpleMbedCloudClient::network_status_changed(nsapi_event_t event, intptr_t status) {
+    if (event != NSAPI_EVENT_CONNECTION_STATUS_CHANGE) return;
+
+    mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::link_status_changed), status);
+
+    if (_failover_enabled) {
+        mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::probe_networks));
+    }
+}
+
+void SimpleMbedCloudClient::link_status_changed(intptr_t status) {
+    if (!_reconnect_enabled) return;
+
+    if (status == NSAPI_STATUS_GLOBAL_UP || status == NSAPI_STATUS_LOCAL_UP) {
+        if (!_closing && !is_client_registered() && _reconnect.on_link_up(Kernel::get_ms_count())) {
+            tr_debug("Link up, reconnecting");
         }
-        status = verify_cloud_configuration(format);
-        if (status != 0) {
-            return status;
+    } else if (status == NSAPI_STATUS_DISCONNECTED) {
+        _reconnect.on_link_down();
+    }
+    schedule_reconnect();
+}
+
+void SimpleMbedCloudClient::register_update() {
+    mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::update_requested));
+}
+
+void SimpleMbedCloudClient::set_register_update_window(uint32_t window_ms) {
+    _update_debouncer.configure(window_ms);
+}
+
+uint32_t SimpleMbedCloudClient::get_register_update_count() {
+    return _update_debouncer.issued();
+}
+
+uint32_t SimpleMbedCloudClient::get_register_update_merged_count() {
+    return _update_debouncer.merged();
+}
+
+void SimpleMbedCloudClient::set_wake_window_period(uint32_t period_ms) {
+    _wake.configure(cap_to_lifetime(period_ms));
+    mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::schedule_wake_window));
+}
+
+mcc_wake_window_stats SimpleMbedCloudClient::get_wake_window_stats() {
+    return _wake.stats();
+}
+
+void SimpleMbedCloudClient::client_registration_updated() {
+    mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::update_completed));
+
+    if (_keepalive_enabled) {
+        mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::keepalive_succeeded));
+    }
+
+    if (_wake.enabled()) {
+        mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::wake_window_opened));
+    }
+}
+
+void SimpleMbedCloudClient::update_requested() {
+    // Sent with the update that opens the next wake window
+    if (_wake.enabled() && !_wake.is_open()) return;
+
+    apply_update_decision(_update_debouncer.on_request(Kernel::get_ms_count()));
+}
+
+void SimpleMbedCloudClient::update_timer_expired() {
+    _update_event = 0;
+    apply_update_decision(_update_debouncer.on_timer(Kernel::get_ms_count()));
+}
+
+void SimpleMbedCloudClient::update_completed() {
+    if (!_update_debouncer.in_flight()) return;
+
+    apply_update_decision(_update_debouncer.on_completed(Kernel::get_ms_count()));
+}
+
+void SimpleMbedCloudClient::apply_update_decision(bool issue) {
+    if (issue) {
+        if (_update_event) {
+            mbed_event_queue()->cancel(_update_event);
+            _update_event = 0;
         }
-#else
+        _cloud_client.register_update();
+        _wake.on_message();
+        return;
+    }
+
+    // The queued update waits for its window, or for the update in flight
+    if (_update_debouncer.pending() && !_update_debouncer.in_flight() && !_update_event) {
+        uint64_t now = Kernel::get_ms_count();
+        uint64_t deadline = _update_debouncer.deadline_ms();
+        int delay = deadline > now ? (int)(deadline - now) : 0;
+        _update_event = mbed_event_queue()->call_in(delay, callback(this, &SimpleMbedCloudClient::update_timer_expired));
+    }
+}
+
+int SimpleMbedCloudClient::enable_dns_cache(uint32_t ttl_s) {
+    if (_dns.open(get_file_system(), ttl_s) != 0) {
+        tr_error("Could not open the DNS cache");
         return 1;
-#endif
     }
 
-    // Deletes existing firmware images from storage.
-    // This deletes any existing firmware images during application startup.
-    // This compilation flag is currently implemented only for mbed OS.
-#ifdef RESET_FIRMWARE
-    palStatus_t status = PAL_SUCCESS;
-    status = pal_fsRmFiles(DEFAULT_FIRMWARE_PATH);
-    if(status == PAL_SUCCESS) {
-        printf("[SMCC] Firmware storage erased\n");
-    } else if (status == PAL_ERR_FS_NO_PATH) {
-        tr_info("Firmware path not found/does not exist");
-    } else {
-        tr_error("Firmware storage erasing failed with %" PRId32, status);
-        return 1;
+    _dns_enabled = true;
+    return 0;
+}
+
+mcc_dns_stats SimpleMbedCloudClient::get_dns_stats() {
+    return _dns.stats();
+}
+
+int SimpleMbedCloudClient::add_network_interface(NetworkInterface *net) {
+    int index = _failover.add();
+    if (index < 0) {
+        tr_error("Too many network interfaces");
+        return 1;
+    }
+
+    _networks[index] = net;
+    if (_failover_enabled || _reconnect_enabled) {
+        net->attach(callback(this, &SimpleMbedCloudClient::network_status_changed));
+    }
+    return 0;
+}
+
+void SimpleMbedCloudClient::enable_failover(uint32_t probe_interval_ms, uint32_t fail_threshold,
+                                            uint32_t recover_threshold) {
+    disable_failover();
+
+    _failover.configure(fail_threshold, recover_threshold);
+    _failover_enabled = true;
+    for (uint32_t i = 0; i < _failover.count(); i++) {
+        _networks[i]->attach(callback(this, &SimpleMbedCloudClient::network_status_changed));
+    }
+
+    _failover_event = mbed_event_queue()->call_every(probe_interval_ms,
+                                                     callback(this, &SimpleMbedCloudClient::probe_networks));
+}
+
+void SimpleMbedCloudClient::disable_failover() {
+    _failover_enabled = false;
+    if (_failover_event) {
+        mbed_event_queue()->cancel(_failover_event);
+        _failover_event = 0;
+    }
+}
+
+NetworkInterface *SimpleMbedCloudClient::get_active_network() {
+    return _net;
+}
+
+uint32_t SimpleMbedCloudClient::get_failover_count() {
+    return _failover.switches();
+}
+
+void SimpleMbedCloudClient::probe_networks() {
+    if (!_failover_enabled) return;
+
+    for (uint32_t i = 0; i < _failover.count(); i++) {
+        _failover.on_probe(i, _networks[i]->get_connection_status() == NSAPI_STATUS_GLOBAL_UP);
+    }
+    failover_check();
+}
+
+void SimpleMbedCloudClient::failover_error() {
+    if (!_failover_enabled) return;
+
+    _failover.on_probe(_failover.active(), false);
+    failover_check();
+}
+
+void SimpleMbedCloudClient::failover_check() {
+    // Only one switch at a time, and not before the application registered
+    if (_failover_switch_to >= 0 || !_register_and_connect_called || _closing) return;
+
+    int index = _failover.next();
+    if (index < 0) return;
+
+    tr_info("Switching from network interface %lu to %d", (unsigned long)_failover.active(), index);
+    _failover_switch_to = index;
+
+    // close() completes on the client thread, registering again before it did would set up
+    // a client that is still closing. Registers again from client_unregistered.
+    bool registered = is_client_registered();
+    _closing = true;
+    _cloud_client.close();
+
+    if (!registered) {
+        _failover_close_event = mbed_event_queue()->call_in(FAILOVER_CLOSE_TIMEOUT_MS,
+                                                            callback(this, &SimpleMbedCloudClient::failover_close_timeout));
+        if (!_failover_close_event) {
+            tr_warn("Could not schedule the network switch, switching now");
+            network_switched();
+        }
+    }
+}
+
+void SimpleMbedCloudClient::failover_close_timeout() {
+    _failover_close_event = 0;
+    network_switched();
+}
+
+void SimpleMbedCloudClient::network_switched() {
+    int index = _failover_switch_to;
+    if (index < 0) return;
+
+    if (_failover_close_event) {
+        mbed_event_queue()->cancel(_failover_close_event);
+        _failover_close_event = 0;
+    }
+
+    _failover_switch_to = -1;
+    _failover.on_switched(index);
+    _net = _networks[index];
+
+    _register_called = false;
+    if (!call_register() && _reconnect_enabled) {
+        reconnect_needed();
+    }
+}
+
+void SimpleMbedCloudClient::enable_adaptive_keepalive(uint32_t min_ms, uint32_t max_ms) {
+    max_ms = cap_to_lifetime(max_ms > 0 ? max_ms : 0xFFFFFFFF);
+    uint32_t resolution_ms = max_ms > min_ms ? (max_ms - min_ms) / 64 : 1;
+
+    _keepalive.configure(min_ms, max_ms, resolution_ms);
+    _keepalive_network = 0;
+    _keepalive_enabled = true;
+
+    if (is_client_registered()) {
+        mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::schedule_keepalive));
+    }
+}
+
+void SimpleMbedCloudClient::disable_adaptive_keepalive() {
+    _keepalive_enabled = false;
+    mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::schedule_keepalive));
+}
+
+uint32_t SimpleMbedCloudClient::get_keepalive_interval() {
+    return _keepalive.next_interval();
+}
+
+void SimpleMbedCloudClient::schedule_keepalive() {
+    if (_keepalive_event) {
+        mbed_event_queue()->cancel(_keepalive_event);
+        _keepalive_event = 0;
+    }
+
+    if (!_keepalive_enabled || !is_client_registered()) return;
+
+    // A different network has a different NAT
+    if (_keepalive_network != network_key(_net)) {
+        load_keepalive();
+    }
+
+    _keepalive_interval_ms = _keepalive.next_interval();
+    _keepalive_traffic = keepalive_traffic();
+    _keepalive_event = mbed_event_queue()->call_in(_keepalive_interval_ms,
+                                                   callback(this, &SimpleMbedCloudClient::keepalive_due));
+}
+
+void SimpleMbedCloudClient::keepalive_due() {
+    _keepalive_event = 0;
+    if (!_keepalive_enabled || !is_client_registered()) return;
+
+    // Other traffic kept the binding alive, so this interval says nothing about it
+    if (keepalive_traffic() != _keepalive_traffic) {
+        schedule_keepalive();
+        return;
+    }
+
+    // Merged into an update that is queued or in flight, which then restarts the idle time
+    // instead of probing it
+    bool issue = _update_debouncer.on_request(Kernel::get_ms_count());
+    if (issue) {
+        _keepalive_probe_ms = _keepalive_interval_ms;
+    }
+    apply_update_decision(issue);
+}
+
+void SimpleMbedCloudClient::keepalive_succeeded() {
+    if (_keepalive_probe_ms) {
+        bool converged = _keepalive.converged();
+        _keepalive.on_result(_keepalive_probe_ms, true);
+        _keepalive_probe_ms = 0;
+        if (!converged) {
+            tr_debug("Keep-alive after %lu ms idle succeeded", (unsigned long)_keepalive_interval_ms);
+            save_keepalive();
+        }
+    }
+
+    // Any registration update restarts the idle time
+    schedule_keepalive();
+}
+
+void SimpleMbedCloudClient::keepalive_failed() {
+    if (!_keepalive_probe_ms) return;
+
+    tr_info("Keep-alive after %lu ms idle failed", (unsigned long)_keepalive_probe_ms);
+    _keepalive.on_result(_keepalive_probe_ms, false);
+    _keepalive_probe_ms = 0;
+    save_keepalive();
+
+    // The next keep-alive is scheduled when the client has registered again
+}
+
+void SimpleMbedCloudClient::load_keepalive() {
+    _keepalive_network = network_key(_net);
+    _keepalive.restore(0, 0);
+
+    keepalive_record records[KEEPALIVE_NETWORKS];
+    int length = _storage.read_file(MBED_CONF_DEVICE_MANAGEMENT_KEEPALIVE_FILE, records, sizeof(records));
+    for (int i = 0; i < length / (int)sizeof(keepalive_record); i++) {
+        if (records[i].network == _keepalive_network) {
+            _keepalive.restore(records[i].good_ms, records[i].bad_ms);
+            tr_debug("Keep-alive of network %08lx: %lu ms", (unsigned long)_keepalive_network,
+                     (unsigned long)_keepalive.next_interval());
+            break;
+        }
+    }
+}
+
+void SimpleMbedCloudClient::save_keepalive() {
+    keepalive_record records[KEEPALIVE_NETWORKS];
+    int length = _storage.read_file(MBED_CONF_DEVICE_MANAGEMENT_KEEPALIVE_FILE, records, sizeof(records));
+    int count = length > 0 ? length / (int)sizeof(keepalive_record) : 0;
+
+    // The current network goes first, the others move down and the last one falls off
+    int index = 0;
+    while (index < count && records[index].network != _keepalive_network) {
+        index++;
+    }
+    if (index == count && count < KEEPALIVE_NETWORKS) {
+        count++;
+    }
+    if (index == KEEPALIVE_NETWORKS) {
+        index--;
+    }
+    memmove(&records[1], &records[0], index * sizeof(keepalive_record));
+
+    records[0].network = _keepalive_network;
+    records[0].good_ms = _keepalive.good_ms();
+    records[0].bad_ms = _keepalive.bad_ms();
+    _storage.write_file(MBED_CONF_DEVICE_MANAGEMENT_KEEPALIVE_FILE, records, count * sizeof(keepalive_record));
+}
+
+uint32_t SimpleMbedCloudClient::keepalive_traffic() {
+    return _diagnostics.notifications_delivered + _diagnostics.notifications_failed +
+           _diagnostics.retransmissions + _update_debouncer.issued();
+}
+
+void SimpleMbedCloudClient::client_sleeping() {
+    mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::wake_window_closed));
+}
+
+void SimpleMbedCloudClient::wake_window_opened() {
+    if (_wake.is_open() || !_wake.enabled()) return;
+
+    _wake.on_wake(Kernel::get_ms_count());
+    schedule_wake_window();
+
+    // Everything held since the last window goes out now
+    tr_debug("Wake window opened, %lu notifications held", (unsigned long)_notifications.pending());
+    send_notifications();
+}
+
+void SimpleMbedCloudClient::wake_window_closed() {
+    if (!_wake.is_open()) return;
+
+    _wake.on_sleep(Kernel::get_ms_count());
+    mcc_wake_window_stats stats = _wake.stats();
+    tr_debug("Wake window ended, %lu messages in %lu ms",
+             (unsigned long)stats.last_messages, (unsigned long)stats.last_awake_ms);
+
+    schedule_wake_window();
+}
+
+void SimpleMbedCloudClient::wake_window_due() {
+    _wake_event = 0;
+    if (_wake.is_open() || !is_client_registered()) return;
+
+    // The registration update wakes the client, and carries any update that was held
+    uint64_t now = Kernel::get_ms_count();
+    _wake.on_wake(now);
+    apply_update_decision(_update_debouncer.on_request(now));
+    send_notifications();
+}
+
+void SimpleMbedCloudClient::schedule_wake_window() {
+    if (_wake_event) {
+        mbed_event_queue()->cancel(_wake_event);
+        _wake_event = 0;
+    }
+
+    if (!_wake.enabled() || _wake.is_open()) return;
+
+    uint64_t now = Kernel::get_ms_count();
+    uint64_t at = _wake.next_window_ms();
+    int delay = at > now ? (int)(at - now) : 0;
+    _wake_event = mbed_event_queue()->call_in(delay, callback(this, &SimpleMbedCloudClient::wake_window_due));
+}
+
+void SimpleMbedCloudClient::client_registered() {
+    _event_flags.set(MCC_EVENT_REGISTERED);
+    core_util_atomic_incr_u32(&_diagnostics.registrations, 1);
+
+    if (_reconnect_enabled) {
+        mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::reconnect_succeeded));
+    }
+
+    if (_offline_queue_capacity > 0 && !_offline_drain_event) {
+        _offline_drain_event = mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::drain_offline_queue));
     }
-#endif
 
-    return 0;
-}
+    if (_wake.enabled()) {
+        mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::wake_window_opened));
+    }
 
-bool SimpleMbedCloudClient::call_register() {
-    // need to unregister first before calling this function again
-    if (_register_called) return false;
+    // High priority notifications that were in flight when the client unregistered
+    _notification_mutex.lock();
+    bool pending = _notifications.pending() > 0;
+    _notification_mutex.unlock();
 
-    _cloud_client.on_registered(this, &SimpleMbedCloudClient::client_registered);
-    _cloud_client.on_unregistered(this, &SimpleMbedCloudClient::client_unregistered);
-    _cloud_client.on_error(this, &SimpleMbedCloudClient::error);
+    uint32_t expected = 0;
+    if (pending && core_util_atomic_cas_u32(&_send_scheduled, &expected, 1)) {
+        mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::send_notifications));
+    }
 
-    bool setup = _cloud_client.setup(_net);
-    _register_called = true;
-    if (!setup) {
-        tr_error("Client setup failed");
-        return false;
+    if (_keepalive_enabled) {
+        mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::schedule_keepalive));
     }
 
-#ifdef MBED_CLOUD_CLIENT_SUPPORT_UPDATE
-    /* Set callback functions for authorizing updates and monitoring progress.
-       Code is implemented in update_ui_example.cpp
-       Both callbacks are completely optional. If no authorization callback
-       is set, the update process will procede immediately in each step.
-    */
-    update_helper_set_cloud_client(&_cloud_client);
-    _cloud_client.set_update_authorize_handler(update_authorize);
-    _cloud_client.set_update_progress_handler(update_progress);
-#endif
-    return true;
-}
+    if (_register_start_ms != 0) {
+        uint64_t now = Kernel::get_ms_count();
+        _timing.registration_ms = (uint32_t)(now - _register_start_ms);
+        if (_timing.total_ms == 0 && _init_start_ms != 0) {
+            _timing.total_ms = (uint32_t)(now - _init_start_ms);
+        }
+        _register_start_ms = 0;
 
-void SimpleMbedCloudClient::close() {
-    _cloud_client.close();
-}
+        mcc_dns_stats dns = _dns.stats();
+        _timing.dns_ms = dns.resolve_ms;
+        _timing.dns_lookups = dns.lookups;
+        _timing.dns_hits = dns.hits;
 
-void SimpleMbedCloudClient::register_update() {
-    _cloud_client.register_update();
-}
+        tr_info("Registered in %lu ms", (unsigned long)_timing.registration_ms);
+        publish_startup_timing();
+    }
 
-void SimpleMbedCloudClient::client_registered() {
-    _registered = true;
     static const ConnectorClientEndpointInfo* endpoint = NULL;
     if (endpoint == NULL) {
         endpoint = _cloud_client.endpoint_info();
@@ -222,9 +1094,26 @@ void SimpleMbedCloudClient::client_registered() {
 }
 
 void SimpleMbedCloudClient::client_unregistered() {
-    _registered = false;
+    _event_flags.clear(MCC_EVENT_REGISTERED);
+    _event_flags.set(MCC_EVENT_UNREGISTERED);
     _register_called = false;
 
+    if (_failover_switch_to >= 0) {
+        mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::network_switched));
+    }
+
+    mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::update_completed));
+    mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::wake_window_closed));
+
+    // No acknowledgement will come for notifications in flight
+    _notification_mutex.lock();
+    _notifications.reset_in_flight();
+    _notification_mutex.unlock();
+
+    if (_reconnect_enabled && !_closing) {
+        mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::reconnect_needed));
+    }
+
     if (_unregistered_cb) {
         _unregistered_cb();
     }
@@ -318,6 +1207,30 @@ void SimpleMbedCloudClient::error(int error_code) {
             error = "UNKNOWN";
     }
 
+    _last_error = error_code;
+    _diagnostics.last_error = error_code;
+    _event_flags.set(MCC_EVENT_ERROR);
+
+    // The server may have dropped the stored session, do a full handshake next time
+    if (error_code == MbedCloudClient::ConnectSecureConnectionFailed) {
+        _storage.clear_ssl_session();
+    }
+
+    // A failed update does not report completion
+    mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::update_completed));
+
+    if (_reconnect_enabled && !_closing && is_connection_error(error_code)) {
+        mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::reconnect_needed));
+    }
+
+    if (_failover_enabled && is_connection_error(error_code)) {
+        mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::failover_error));
+    }
+
+    if (_keepalive_enabled && is_connection_error(error_code)) {
+        mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::keepalive_failed));
+    }
+
     if (_error_cb) {
         _error_cb(error_code, error);
         return;
@@ -329,7 +1242,33 @@ void SimpleMbedCloudClient::error(int error_code) {
 }
 
 bool SimpleMbedCloudClient::is_client_registered() {
-    return _registered;
+    return (_event_flags.get() & MCC_EVENT_REGISTERED) != 0;
+}
+
+bool SimpleMbedCloudClient::wait_for_registration(uint32_t timeout_ms) {
+    return wait_for_event(MCC_EVENT_REGISTERED, timeout_ms) != 0;
+}
+
+uint32_t SimpleMbedCloudClient::wait_for_event(uint32_t events, uint32_t timeout_ms) {
+    uint32_t flags = _event_flags.wait_any(events, timeout_ms, false);
+    if (flags & osFlagsError) {
+        return 0;
+    }
+
+    // Registered is a state, the others are one-shot events
+    flags &= events;
+    if (flags & (MCC_EVENT_UNREGISTERED | MCC_EVENT_ERROR)) {
+        _event_flags.clear(flags & (MCC_EVENT_UNREGISTERED | MCC_EVENT_ERROR));
+    }
+    return flags;
+}
+
+uint32_t SimpleMbedCloudClient::get_events(uint32_t events) {
+    return _event_flags.get() & events;
+}
+
+int SimpleMbedCloudClient::get_last_error() {
+    return _last_error;
 }
 
 bool SimpleMbedCloudClient::is_register_called() {
@@ -339,15 +1278,28 @@ bool SimpleMbedCloudClient::is_register_called() {
 bool SimpleMbedCloudClient::register_and_connect() {
     if (_register_and_connect_called) return false;
 
-    mcc_resource_def resourceDef;
+#ifdef MBED_CONF_DEVICE_MANAGEMENT_STARTUP_TIMING_RESOURCE
+    if (_timing_resource == NULL) {
+        _timing_resource = create_resource(MBED_CONF_DEVICE_MANAGEMENT_STARTUP_TIMING_RESOURCE, "startup_timing");
+        _timing_resource->methods(M2MMethod::GET);
+    }
+#endif
+
+#ifdef MBED_CONF_DEVICE_MANAGEMENT_DIAGNOSTICS_OBJECT_ID
+    create_diagnostics_object();
+#endif
+
+    // Index the objects while they are created, so each lookup is a binary search rather than a list scan
+    ResourceIndex index;
 
-    for (int i = 0; i < _resources.size(); i++) {
-        _resources[i]->get_data(&resourceDef);
-        M2MResource *res = add_resource(&_obj_list, resourceDef.object_id, resourceDef.instance_id,
-                    resourceDef.resource_id, resourceDef.name.c_str(), M2MResourceInstance::STRING,
-                    (M2MBase::Operation)resourceDef.method_mask, resourceDef.value.c_str(), resourceDef.observable,
-                    resourceDef.put_callback, resourceDef.post_callback, resourceDef.notification_callback);
-        _resources[i]->set_m2m_resource(res);
+    // Read the resources directly rather than through get_data(), which copies into heap-backed strings
+    for (MbedCloudClientResource *r = _resources; r != NULL; r = r->next) {
+        const char *value = (r->dataType == M2MResourceInstance::STRING && r->value) ? r->value : "";
+        M2MResource *res = ::add_resource(&_obj_list, r->objectId, r->instanceId,
+                    r->resourceId, r->name, r->dataType,
+                    (M2MBase::Operation)r->methodMask, value, r->isObservable,
+                    &r->internalPutCallback, &r->internalPostCallback, &r->internalNotificationCallback, &index);
+        r->set_m2m_resource(res);
     }
     _cloud_client.add_objects(_obj_list);
 
@@ -365,6 +1317,72 @@ bool SimpleMbedCloudClient::register_and_connect() {
     return retval;
 }
 
+void SimpleMbedCloudClient::begin_batch() {
+    _batch_thread = ThisThread::get_id();
+}
+
+bool SimpleMbedCloudClient::is_batch_active() {
+    return _batch_thread != NULL && _batch_thread == ThisThread::get_id();
+}
+
+int SimpleMbedCloudClient::commit() {
+    _batch_thread = NULL;
+
+    return publish_staged(MbedCloudClientResource::STAGED_BATCH);
+}
+
+int SimpleMbedCloudClient::publish_staged(uint8_t tag) {
+    _batch_mutex.lock();
+
+    // Store every value first, so a notification of an object instance carries all of them
+    int published = 0;
+    for (MbedCloudClientResource *r = _resources; r != NULL; r = r->next) {
+        if (r->store_staged(tag)) {
+            published++;
+        }
+    }
+
+    // Then notify each object instance once, the inner walk only visits the rest of the list
+    for (MbedCloudClientResource *r = _resources; r != NULL; r = r->next) {
+        if (!r->reportPending) continue;
+
+        bool instance_notified = false;
+        for (MbedCloudClientResource *other = r; other != NULL; other = other->next) {
+            if (!other->reportPending || other->objectId != r->objectId || other->instanceId != r->instanceId) continue;
+
+            other->reportPending = false;
+            if (other->report_stored(!instance_notified)) {
+                instance_notified = true;
+            }
+        }
+    }
+
+    _batch_mutex.unlock();
+    return published;
+}
+
+void SimpleMbedCloudClient::value_posted() {
+    uint32_t expected = 0;
+    if (core_util_atomic_cas_u32(&_drain_scheduled, &expected, 1) &&
+        !mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::drain_posted_values))) {
+        // The event queue is full, let the next post try again
+        _drain_scheduled = 0;
+    }
+}
+
+void SimpleMbedCloudClient::drain_posted_values() {
+    // Values posted from here on need another drain
+    _drain_scheduled = 0;
+
+    // Stage all slots and publish them together. This does not use the batch of the
+    // application, which may be open on another thread.
+    for (MbedCloudClientResource *r = _resources; r != NULL; r = r->next) {
+        r->drain_posted();
+    }
+
+    publish_staged(MbedCloudClientResource::STAGED_POSTED);
+}
+
 void SimpleMbedCloudClient::on_registered(Callback<void(const ConnectorClientEndpointInfo*)> cb) {
     _registered_cb = cb;
 }
@@ -389,16 +1407,366 @@ int SimpleMbedCloudClient::reformat_storage() {
     return _storage.reformat_storage();
 }
 
+void SimpleMbedCloudClient::notification_limits(uint32_t max_in_flight, uint32_t max_pending) {
+    _notification_mutex.lock();
+    _notifications.configure(max_in_flight, max_pending);
+    _notification_mutex.unlock();
+}
+
+mcc_priority_stats SimpleMbedCloudClient::get_notification_stats(mcc_priority priority) {
+    _notification_mutex.lock();
+    mcc_priority_stats stats = _notifications.stats(priority);
+    _notification_mutex.unlock();
+    return stats;
+}
+
+bool SimpleMbedCloudClient::set_notification_priority(MbedCloudClientResource *resource, mcc_priority priority) {
+    _notification_mutex.lock();
+
+    // The scheduler keeps an entry in the list of its priority until it is acknowledged
+    bool idle = !resource->notifyEntry.queued && !resource->notifyEntry.in_flight;
+    if (idle) {
+        resource->notifyEntry.priority = priority;
+    }
+
+    _notification_mutex.unlock();
+    return idle;
+}
+
+bool SimpleMbedCloudClient::schedule_notification(MbedCloudClientResource *resource) {
+    // Without an observer Mbed Cloud Client sends nothing, so there is no acknowledgement to wait for
+    if ((!_notifications.enabled() && !_wake.enabled()) || resource->resource->observation_level() == M2MBase::None) {
+        return false;
+    }
+
+    _notification_mutex.lock();
+    NotificationScheduler::Entry *dropped = _notifications.enqueue(&resource->notifyEntry, Kernel::get_ms_count());
+    _notification_mutex.unlock();
+
+    if (dropped) {
+        // Store the value of the dropped notification without sending it. This runs with the
+        // lock of the resource that is scheduled held, so lock the dropped one on the event queue.
+        MbedCloudClientResource *r = (MbedCloudClientResource*)dropped->owner;
+        tr_debug("Dropped notification of %u/%u/%u", r->objectId, r->instanceId, r->resourceId);
+        if (!mbed_event_queue()->call(callback(r, &MbedCloudClientResource::store_dropped))) {
+            tr_warn("Could not store the value of %u/%u/%u", r->objectId, r->instanceId, r->resourceId);
+        }
+    }
+
+    // An alarm does not wait for the next wake window
+    if (_wake.enabled() && !_wake.is_open() && resource->notifyEntry.priority == MCC_PRIORITY_HIGH) {
+        mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::wake_window_due));
+        return true;
+    }
+
+    uint32_t expected = 0;
+    if (core_util_atomic_cas_u32(&_send_scheduled, &expected, 1)) {
+        mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::send_notifications));
+    }
+    return true;
+}
+
+void SimpleMbedCloudClient::notification_status(MbedCloudClientResource *resource, NoticationDeliveryStatus status) {
+    bool delivered;
+    switch (status) {
+        case NOTIFICATION_STATUS_SENT:
+            // Mbed Cloud Client reports SENT again for every CoAP retransmission
+            if (resource->notifySentCount++ > 0) {
+                core_util_atomic_incr_u32(&_diagnostics.retransmissions, 1);
+            }
+            return;
+        case NOTIFICATION_STATUS_DELIVERED: {
+            core_util_atomic_incr_u32(&_diagnostics.notifications_delivered, 1);
+            // Smoothed like the TCP round-trip time, srtt = 7/8 srtt + 1/8 sample
+            uint32_t sample = (uint32_t)Kernel::get_ms_count() - resource->notifySentMs;
+            uint32_t srtt = _diagnostics.rtt_ms;
+            _diagnostics.rtt_ms = srtt == 0 ? sample : srtt - (srtt >> 3) + (sample >> 3);
+            delivered = true;
+            break;
+        }
+        case NOTIFICATION_STATUS_BUILD_ERROR:
+        case NOTIFICATION_STATUS_RESEND_QUEUE_FULL:
+        case NOTIFICATION_STATUS_SEND_FAILED:
+            core_util_atomic_incr_u32(&_diagnostics.notifications_failed, 1);
+            delivered = false;
+            break;
+        case NOTIFICATION_STATUS_UNSUBSCRIBED:
+            delivered = false;
+            break;
+        default:
+            return;
+    }
+
+    _notification_mutex.lock();
+    _notifications.complete(&resource->notifyEntry, delivered, Kernel::get_ms_count());
+    bool more = _notifications.pending() > 0;
+    _notification_mutex.unlock();
+
+    uint32_t expected = 0;
+    if (more && core_util_atomic_cas_u32(&_send_scheduled, &expected, 1)) {
+        mbed_event_queue()->call(callback(this, &SimpleMbedCloudClient::send_notifications));
+    }
+}
+
+void SimpleMbedCloudClient::send_notifications() {
+    // Notifications queued from here on need another pass
+    _send_scheduled = 0;
+
+    // Held until the next wake window
+    if (_wake.enabled() && !_wake.is_open()) return;
+
+    bool sent = false;
+    while (true) {
+        _notification_mutex.lock();
+        NotificationScheduler::Entry *entry = _notifications.next(Kernel::get_ms_count());
+        _notification_mutex.unlock();
+
+        if (!entry) break;
+
+        ((MbedCloudClientResource*)entry->owner)->send_scheduled();
+        _wake.on_message();
+        sent = true;
+    }
+
+    if (sent) {
+        schedule_notification_expiry();
+    }
+}
+
+void SimpleMbedCloudClient::schedule_notification_expiry() {
+    if (_notification_expiry_event) return;
+
+    _notification_mutex.lock();
+    uint64_t sent_ms;
+    bool in_flight = _notifications.oldest_in_flight(&sent_ms);
+    _notification_mutex.unlock();
+
+    if (!in_flight) return;
+
+    uint64_t due_ms = sent_ms + MBED_CONF_DEVICE_MANAGEMENT_NOTIFICATION_IN_FLIGHT_TIMEOUT_MS;
+    uint64_t now_ms = Kernel::get_ms_count();
+    _notification_expiry_event = mbed_event_queue()->call_in(due_ms > now_ms ? (int)(due_ms - now_ms) : 0,
+                                                             callback(this, &SimpleMbedCloudClient::expire_notifications));
+}
+
+void SimpleMbedCloudClient::expire_notifications() {
+    _notification_expiry_event = 0;
+
+    _notification_mutex.lock();
+    uint32_t expired = _notifications.expire(Kernel::get_ms_count(), MBED_CONF_DEVICE_MANAGEMENT_NOTIFICATION_IN_FLIGHT_TIMEOUT_MS);
+    bool more = _notifications.pending() > 0;
+    _notification_mutex.unlock();
+
+    if (expired > 0) {
+        tr_warn("%lu notifications were not acknowledged in time", (unsigned long)expired);
+        core_util_atomic_incr_u32(&_diagnostics.notifications_failed, expired);
+    }
+
+    if (expired > 0 && more) {
+        send_notifications();
+    }
+
+    schedule_notification_expiry();
+}
+
+int SimpleMbedCloudClient::enable_offline_queue(uint32_t capacity, mcc_queue_overflow overflow, uint32_t drain_rate) {
+    _offline_queue_mutex.lock();
+
+    _offline_queue.close();
+    _offline_queue_capacity = capacity;
+    _offline_queue_overflow = overflow;
+    _offline_drain_interval_ms = drain_rate > 0 ? 1000 / drain_rate : 1000;
+
+    // Without a file system yet, the queue is opened on first use
+    int status = 0;
+    if (capacity > 0 && get_file_system() && !open_offline_queue()) {
+        status = 1;
+    }
+
+    _offline_queue_mutex.unlock();
+    return status;
+}
+
+void SimpleMbedCloudClient::on_queued_value(Callback<void(MbedCloudClientResource*, uint32_t)> cb) {
+    _queued_value_cb = cb;
+}
+
+uint32_t SimpleMbedCloudClient::get_offline_queue_count() {
+    return _offline_queue.count();
+}
+
+uint32_t SimpleMbedCloudClient::get_offline_queue_dropped() {
+    return _offline_queue.dropped();
+}
+
+bool SimpleMbedCloudClient::open_offline_queue() {
+    if (_offline_queue.is_open()) return true;
+
+    return _offline_queue.open(get_file_system(), _offline_queue_capacity, _offline_queue_overflow,
+                               MBED_CONF_DEVICE_MANAGEMENT_OFFLINE_QUEUE_SYNC_INTERVAL) == 0;
+}
+
+bool SimpleMbedCloudClient::queue_value(MbedCloudClientResource *resource) {
+    if (_offline_queue_capacity == 0 || !resource->isObservable) return false;
+
+    _offline_queue_mutex.lock();
+
+    bool queued = false;
+    if ((!is_client_registered() || _offline_queue.count() > 0) && open_offline_queue()) {
+        mcc_queued_record record;
+        if (resource->fill_queued_record(&record)) {
+            queued = _offline_queue.push(&record) >= 0;
+        }
+    }
+
+    _offline_queue_mutex.unlock();
+    return queued;
+}
+
+void SimpleMbedCloudClient::drain_offline_queue() {
+    _offline_drain_event = 0;
+    if (!is_client_registered()) return;
+
+    _offline_queue_mutex.lock();
+
+    mcc_queued_record record;
+    if (!open_offline_queue() || _offline_queue.peek(&record) != 0) {
+        _offline_queue_mutex.unlock();
+        return;
+    }
+    _offline_queue.pop();
+    bool more = _offline_queue.count() > 0;
+    if (!more) {
+        // Drained, commit so the sent values are not sent again after a reset
+        _offline_queue.sync();
+    }
+
+    _offline_queue_mutex.unlock();
+
+    for (MbedCloudClientResource *r = _resources; r != NULL; r = r->next) {
+        if (r->objectId == record.object_id && r->instanceId == record.instance_id &&
+            r->resourceId == record.resource_id) {
+            if (_queued_value_cb) {
+                _queued_value_cb(r, record.timestamp);
+            }
+            r->apply_queued_record(&record);
+            break;
+        }
+    }
+
+    if (more) {
+        _offline_drain_event = mbed_event_queue()->call_in(_offline_drain_interval_ms,
+                                                           callback(this, &SimpleMbedCloudClient::drain_offline_queue));
+    }
+}
+
+mcc_diagnostics SimpleMbedCloudClient::get_diagnostics() {
+    mcc_diagnostics diagnostics = _diagnostics;
+
+#if MBED_CONF_NSAPI_SOCKET_STATS_ENABLED
+    // Closed sockets keep their counts until the slot is reused
+    mbed_stats_socket_t stats[MBED_CONF_NSAPI_SOCKET_STATS_MAX_COUNT];
+    size_t count = SocketStats::mbed_stats_socket_get_each(stats, MBED_CONF_NSAPI_SOCKET_STATS_MAX_COUNT);
+    for (size_t i = 0; i < count; i++) {
+        diagnostics.bytes_sent += (uint32_t)stats[i].sent_bytes;
+        diagnostics.bytes_received += (uint32_t)stats[i].recv_bytes;
+    }
+#endif
+
+    return diagnostics;
+}
+
+void SimpleMbedCloudClient::create_diagnostics_object() {
+#ifdef MBED_CONF_DEVICE_MANAGEMENT_DIAGNOSTICS_OBJECT_ID
+    static const char * const names[] = {
+        "registrations", "reconnects", "last_error", "rtt_ms", "retransmissions",
+        "bytes_sent", "bytes_received", "notifications_delivered", "notifications_failed"
+    };
+
+    if (_diagnostics_resources[0] != NULL) return;
+
+    for (uint16_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        MbedCloudClientResource *r = new MbedCloudClientResource(MBED_CONF_DEVICE_MANAGEMENT_DIAGNOSTICS_OBJECT_ID, 0, i,
+                                                                 names[i], M2MResourceInstance::INTEGER,
+                                                                 M2MMethod::GET, true);
+        r->client = this;
+        append_resource(r, true);
+        _diagnostics_resources[i] = r;
+    }
+
+    _diagnostics_event = mbed_event_queue()->call_every(MBED_CONF_DEVICE_MANAGEMENT_DIAGNOSTICS_PERIOD_MS,
+                                                        callback(this, &SimpleMbedCloudClient::publish_diagnostics));
+#endif
+}
+
+void SimpleMbedCloudClient::publish_diagnostics() {
+    if (_diagnostics_resources[0] == NULL || !is_client_registered()) return;
+
+    mcc_diagnostics diagnostics = get_diagnostics();
+    const int32_t values[] = {
+        (int32_t)diagnostics.registrations, (int32_t)diagnostics.reconnects, diagnostics.last_error,
+        (int32_t)diagnostics.rtt_ms, (int32_t)diagnostics.retransmissions,
+        (int32_t)diagnostics.bytes_sent, (int32_t)diagnostics.bytes_received,
+        (int32_t)diagnostics.notifications_delivered, (int32_t)diagnostics.notifications_failed
+    };
+
+    // Unchanged values are not written, so they do not trigger a notification
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        if (_diagnostics_resources[i]->get_value_int() != values[i]) {
+            _diagnostics_resources[i]->set_value((int)values[i]);
+        }
+    }
+}
+
+mcc_startup_timing SimpleMbedCloudClient::get_startup_timing() {
+    return _timing;
+}
+
+void SimpleMbedCloudClient::publish_startup_timing() {
+    if (_timing_resource == NULL) return;
+
+    char buffer[192];
+    snprintf(buffer, sizeof(buffer), "trace=%lu,fcc=%lu,storage=%lu,sotp=%lu,verify=%lu,registration=%lu,total=%lu,cached=%d,"
+             "dns=%lu,dns_hits=%lu/%lu",
+             (unsigned long)_timing.trace_ms, (unsigned long)_timing.fcc_ms, (unsigned long)_timing.storage_ms,
+             (unsigned long)_timing.sotp_ms, (unsigned long)_timing.verify_ms,
+             (unsigned long)_timing.registration_ms, (unsigned long)_timing.total_ms, _timing.verify_cached ? 1 : 0,
+             (unsigned long)_timing.dns_ms, (unsigned long)_timing.dns_hits, (unsigned long)_timing.dns_lookups);
+    _timing_resource->set_value(buffer);
+}
+
+FileSystem *SimpleMbedCloudClient::get_file_system() {
+    return _storage.get_file_system();
+}
+
 MbedCloudClient *SimpleMbedCloudClient::get_cloud_client() {
     return &_cloud_client;
 }
 
-MbedCloudClientResource* SimpleMbedCloudClient::create_resource(const char *path, const char *name) {
-    MbedCloudClientResource *resource = new MbedCloudClientResource(this, path, name);
-    _resources.push_back(resource);
+MbedCloudClientResource* SimpleMbedCloudClient::create_resource(const char *path, const char *name,
+                                                                M2MResourceInstance::ResourceType type) {
+    MbedCloudClientResource *resource = new MbedCloudClientResource(this, path, name, type);
+    append_resource(resource, true);
     return resource;
 }
 
+void SimpleMbedCloudClient::add_resource(MbedCloudClientResource *resource) {
+    resource->client = this;
+    append_resource(resource, false);
+}
+
+void SimpleMbedCloudClient::append_resource(MbedCloudClientResource *resource, bool managed) {
+    resource->managed = managed;
+    resource->next = NULL;
+
+    if (_resources_tail) {
+        _resources_tail->next = resource;
+    } else {
+        _resources = resource;
+    }
+    _resources_tail = resource;
+}
+
 int SimpleMbedCloudClient::reset_storage() {
     tr_info("Resetting storage to an empty state...");
     int status = fcc_storage_delete();
@@ -430,6 +1798,20 @@ int SimpleMbedCloudClient::reset_storage() {
 int SimpleMbedCloudClient::verify_cloud_configuration(bool format) {
     int status;
 
+#if MBED_CONF_DEVICE_MANAGEMENT_VERIFIED_CONFIG_CACHE == 1
+    uint8_t digest[VERIFIED_CONFIG_DIGEST_SIZE];
+    uint8_t cached[VERIFIED_CONFIG_DIGEST_SIZE];
+
+    if (!format && compute_config_digest(digest) == 0 &&
+        _storage.read_file(VERIFIED_CONFIG_FILE, cached, sizeof(cached)) == (int)sizeof(cached) &&
+        memcmp(digest, cached, sizeof(digest)) == 0) {
+        tr_debug("Configuration unchanged since last verification, skipping verification");
+        _timing.verify_cached = true;
+        return 0;
+    }
+    _timing.verify_cached = false;
+#endif
+
 #if MBED_CONF_DEVICE_MANAGEMENT_DEVELOPER_MODE == 1
     tr_debug("Starting developer flow");
     if( format ) {
@@ -448,5 +1830,81 @@ int SimpleMbedCloudClient::verify_cloud_configuration(bool format) {
     }
 #endif
     status = fcc_verify_device_configured_4mbed_cloud();
+
+#if MBED_CONF_DEVICE_MANAGEMENT_VERIFIED_CONFIG_CACHE == 1
+    // The developer flow may have just written the credentials, so hash them again
+    if (status == FCC_STATUS_SUCCESS && compute_config_digest(digest) == 0) {
+        _storage.write_file(VERIFIED_CONFIG_FILE, digest, sizeof(digest));
+    } else {
+        _storage.remove_file(VERIFIED_CONFIG_FILE);
+    }
+#endif
+
+    return status;
+}
+
+#if MBED_CONF_DEVICE_MANAGEMENT_VERIFIED_CONFIG_CACHE == 1
+int SimpleMbedCloudClient::compute_config_digest(uint8_t *digest) {
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts_ret(&ctx, 0);
+
+    const char *version = VERIFIED_CONFIG_VERSION;
+    mbedtls_sha256_update_ret(&ctx, (const unsigned char*)version, strlen(version) + 1);
+
+    int status = 0;
+    for (size_t i = 0; i < sizeof(verified_config_items) / sizeof(verified_config_items[0]); i++) {
+        const char *name = verified_config_items[i].name;
+        size_t name_len = strlen(name);
+        size_t size = 0;
+
+        kcm_status_e kcm_status = kcm_item_get_data_size((const uint8_t*)name, name_len,
+                                                         verified_config_items[i].type, &size);
+        if (kcm_status == KCM_STATUS_ITEM_NOT_FOUND) {
+            size = 0;
+        } else if (kcm_status != KCM_STATUS_SUCCESS) {
+            status = 1;
+            break;
+        }
+
+        // Hash the name and the size as well, so a missing item differs from an empty one
+        uint8_t header[4] = { (uint8_t)(size >> 24), (uint8_t)(size >> 16), (uint8_t)(size >> 8), (uint8_t)size };
+        mbedtls_sha256_update_ret(&ctx, (const unsigned char*)name, name_len + 1);
+        mbedtls_sha256_update_ret(&ctx, header, sizeof(header));
+        if (size == 0) continue;
+
+        uint8_t *buffer = (uint8_t*)malloc(size);
+        if (!buffer) {
+            status = 1;
+            break;
+        }
+        size_t actual = 0;
+        kcm_status = kcm_item_get_data((const uint8_t*)name, name_len, verified_config_items[i].type,
+                                       buffer, size, &actual);
+        if (kcm_status == KCM_STATUS_SUCCESS) {
+            mbedtls_sha256_update_ret(&ctx, buffer, actual);
+        }
+        mbedtls_platform_zeroize(buffer, size);
+        free(buffer);
+        if (kcm_status != KCM_STATUS_SUCCESS) {
+            status = 1;
+            break;
+        }
+    }
+
+    if (status == 0) {
+        mbedtls_sha256_finish_ret(&ctx, digest);
+    } else {
+        // Do not leave the state of a partial hash of the credentials behind
+        mbedtls_platform_zeroize(&ctx, sizeof(ctx));
+    }
+    mbedtls_sha256_free(&ctx);
+
     return status;
 }
+#else
+int SimpleMbedCloudClient::compute_config_digest(uint8_t *digest) {
+    (void)digest;
+    return 1;
+}
+#endif
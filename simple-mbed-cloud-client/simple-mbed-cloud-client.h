@@ -26,12 +26,77 @@
 #include "mbed-client/m2mvector.h"
 #include "mbed-cloud-client-resource.h"
 #include "storage-helper/storage-helper.h"
+#include "reconnect-backoff.h"
+#include "registration-update-debouncer.h"
+#include "notification-queue.h"
+#include "notification-scheduler.h"
+#include "wake-window-scheduler.h"
+#include "keepalive-probe.h"
+#include "network-failover.h"
+#include "dns-cache.h"
 #include "mbed.h"
 #include "NetworkInterface.h"
 
 class MbedCloudClientResource;
 
+/**
+ * Duration of each phase of the startup, in milliseconds.
+ * A phase that did not run (yet) is 0.
+ */
+struct mcc_startup_timing {
+    uint32_t trace_ms;          // Mbed Trace initialization
+    uint32_t fcc_ms;            // fcc_init()
+    uint32_t storage_ms;        // Mounting the storage, and resetting it when needed
+    uint32_t sotp_ms;           // SOTP initialization
+    uint32_t verify_ms;         // Credential verification
+    uint32_t registration_ms;   // Client setup until registered
+    uint32_t total_ms;          // Start of init() until first registered
+    uint32_t dns_ms;            // Waiting for the DNS server until registered
+    uint32_t dns_lookups;       // Host names looked up until registered
+    uint32_t dns_hits;          // Lookups answered from the DNS cache
+    bool verify_cached;         // Verification was skipped, the configuration matched the cache
+};
+
+/**
+ * Connection and transport counters since boot
+ */
+struct mcc_diagnostics {
+    uint32_t registrations;             // Successful registrations
+    uint32_t reconnects;                // Reconnect attempts by the reconnect scheduler
+    int32_t last_error;                 // Last MbedCloudClient::Error code, 0 if none
+    uint32_t rtt_ms;                    // Smoothed time from sending a notification to its acknowledgement
+    uint32_t retransmissions;           // Notifications reported as sent more than once
+    uint32_t bytes_sent;                // Bytes sent on all sockets, 0 without nsapi socket stats
+    uint32_t bytes_received;            // Bytes received on all sockets, 0 without nsapi socket stats
+    uint32_t notifications_delivered;   // Notifications acknowledged
+    uint32_t notifications_failed;      // Notifications that could not be built or sent, or were not acknowledged in time
+};
+
+/**
+ * Steps of init() and init_async(), in the order they run
+ */
+enum mcc_init_step {
+    MCC_INIT_TRACE,             // Mbed Trace initialization
+    MCC_INIT_FCC,               // Factory configurator client initialization
+    MCC_INIT_STORAGE,           // Mounting the storage
+    MCC_INIT_SOTP,              // SOTP initialization
+    MCC_INIT_RESET_STORAGE,     // Resetting the storage (RESET_STORAGE, or no valid credentials)
+    MCC_INIT_VERIFY,            // Credential verification
+    MCC_INIT_ERASE_FIRMWARE,    // Erasing stored firmware images (RESET_FIRMWARE)
+    MCC_INIT_DONE
+};
+
+/**
+ * Client events, used as a mask by wait_for_event() and get_events()
+ */
+enum mcc_client_event {
+    MCC_EVENT_REGISTERED    = 0x1,  // Set while the client is registered
+    MCC_EVENT_UNREGISTERED  = 0x2,  // The client unregistered, cleared when waited for
+    MCC_EVENT_ERROR         = 0x4   // An error occurred, cleared when waited for
+};
+
 class SimpleMbedCloudClient {
+    friend class MbedCloudClientResource;
 
 public:
 
@@ -64,19 +129,292 @@ public:
      */
     int init(bool format = false);
 
+    /**
+     * Initialize SimpleMbedCloudClient without blocking the caller
+     *
+     * Runs the same steps as 'init', one event at a time on an event queue.
+     * Each step still blocks the thread that dispatches the queue while it runs,
+     * formatting an SD card can take minutes, so use a dedicated queue
+     * if other events on the shared queue cannot wait that long.
+     *
+     * @param done_cb Called when init finished, with 0 if successful or the error of 'init'
+     * @param progress_cb Called after each successful step, with the step that finished
+     * @param format If set to true, will always format the file system
+     * @param queue Event queue to run on, NULL for the shared event queue
+     *
+     * @returns 0 if init was started, 1 if init is already running or could not be scheduled
+     */
+    int init_async(Callback<void(int)> done_cb, Callback<void(mcc_init_step)> progress_cb = NULL,
+                   bool format = false, EventQueue *queue = NULL);
+
     /**
      * Close the connection to Pelion Device Management and unregister the device
+     *
+     * The reconnect scheduler does not re-register after this.
      */
     void close();
 
+    /**
+     * Re-register automatically after the client unregistered or a connection error occurred
+     *
+     * The delay before each attempt is drawn at random between 0 and
+     * min(max_delay_ms, base_delay_ms * 2^attempt), so devices that lost the connection
+     * at the same moment do not reconnect at the same moment.
+     * This attaches a status callback to the network interface, which replaces any callback
+     * the application attached. When the link comes back up the next attempt is made
+     * within link_up_jitter_ms, instead of waiting for the backoff timer.
+     * The scheduler runs on the shared event queue.
+     *
+     * @param base_delay_ms Maximum delay before the first attempt
+     * @param max_delay_ms Maximum delay before any attempt
+     * @param retry_budget Number of attempts until the next successful registration, 0 for no limit
+     * @param link_up_jitter_ms Maximum delay after the link came up
+     */
+    void enable_reconnect(uint32_t base_delay_ms = 1000, uint32_t max_delay_ms = 600000,
+                          uint32_t retry_budget = 0, uint32_t link_up_jitter_ms = 5000);
+
+    /**
+     * Stop re-registering automatically
+     */
+    void disable_reconnect();
+
+    /**
+     * Get the number of reconnect attempts since the last successful registration
+     */
+    uint32_t get_reconnect_attempts();
+
+    /**
+     * Add a backup network interface, after the ones added before
+     *
+     * The interface passed to the constructor is the primary one. Connect each
+     * backup interface before adding it, so it can be probed and used at once.
+     *
+     * @param net Connected network interface
+     *
+     * @returns 0 if successful, 1 if NETWORK_FAILOVER_MAX interfaces were added already
+     */
+    int add_network_interface(NetworkInterface *net);
+
+    /**
+     * Switch to a backup network interface when the active one fails, and back once
+     * an interface earlier in the list has recovered
+     *
+     * Every probe interval, an interface passes its probe when its connection status is
+     * NSAPI_STATUS_GLOBAL_UP. The probe does not check that Pelion Device Management can
+     * be reached over the interface, so a link that is up but blocked further upstream
+     * only fails through the connection errors of the active interface: a connection
+     * error of Mbed Cloud Client counts as a failed probe of the active interface.
+     * A status change of any interface probes at once.
+     * To switch, the client closes the connection and registers again over the other
+     * interface, with the same objects and credentials; init() is not run again.
+     * This attaches a status callback to every interface, which replaces any callback
+     * the application attached.
+     *
+     * @param probe_interval_ms Time between two probes of all interfaces
+     * @param fail_threshold Failed probes in a row after which an interface is not used
+     * @param recover_threshold Good probes in a row after which an interface is used again
+     */
+    void enable_failover(uint32_t probe_interval_ms = 30000, uint32_t fail_threshold = 3,
+                         uint32_t recover_threshold = 5);
+
+    /**
+     * Stop probing the network interfaces, the active one stays in use
+     */
+    void disable_failover();
+
+    /**
+     * Get the network interface in use
+     */
+    NetworkInterface *get_active_network();
+
+    /**
+     * Get the number of switches between network interfaces
+     */
+    uint32_t get_failover_count();
+
+    /**
+     * Learn how long the NAT binding of the network survives an idle connection,
+     * and send registration updates just often enough to keep it
+     *
+     * After each idle interval a registration update is sent. If it completes, the
+     * binding lasted and a longer interval is tried; if it fails with a connection
+     * error, a shorter one. The search halves the range each time, and ends within
+     * 1/64 of the range. Intervals with other traffic do not count.
+     * The result is kept per network in device-management.keepalive-file, so the next
+     * boot on the same network starts from it. Enable automatic reconnects to recover
+     * from a failed probe.
+     *
+     * A network is identified by its gateway address, its netmask and the MAC address
+     * of the interface, as Mbed OS does not expose the Wi-Fi SSID or the cellular
+     * operator. Networks that share all three share one result, e.g. two home routers
+     * at 192.168.1.1 reached through the same Wi-Fi interface, or cellular networks that
+     * report no gateway. On such a network a failed probe moves the search back down.
+     *
+     * @param min_ms Shortest interval, assumed to be safe
+     * @param max_ms Longest interval, 0 for 3/4 of the registration lifetime
+     */
+    void enable_adaptive_keepalive(uint32_t min_ms = 30000, uint32_t max_ms = 0);
+
+    /**
+     * Stop sending keep-alive registration updates
+     */
+    void disable_adaptive_keepalive();
+
+    /**
+     * Get the idle interval before the next keep-alive
+     *
+     * @returns Interval in ms, a probe while the search has not ended
+     */
+    uint32_t get_keepalive_interval();
+
+    /**
+     * Resolve the bootstrap and LwM2M server host names from a cache in
+     * device-management.dns-cache-file, so registering does not wait for DNS
+     *
+     * A cached address is used at once. When it is older than the TTL, or the clock
+     * is not set, it is resolved again in the background for the next registration.
+     * Only host names that are not cached yet wait for the DNS server. Blocking and
+     * asynchronous lookups (gethostbyname and gethostbyname_async) both use the cache.
+     * Call after init(), the cache is read from the primary partition.
+     *
+     * @param ttl_s Age in seconds after which a cached address is refreshed
+     *
+     * @returns 0 if successful, non-0 if the file system is not available
+     */
+    int enable_dns_cache(uint32_t ttl_s = 86400);
+
+    /**
+     * Get the counters of the DNS cache
+     *
+     * @returns Lookups, cache hits, time spent waiting for DNS and background refreshes
+     */
+    mcc_dns_stats get_dns_stats();
+
+    /**
+     * Queue the values of observable resources while the client is not registered
+     *
+     * Values are kept in a file on the primary partition (device-management.offline-queue-file),
+     * so they survive a reboot. After registering, the queue is sent in order at the drain rate,
+     * and new values are queued behind it until it is empty.
+     * To spare the flash, the file is committed every device-management.offline-queue-sync-interval
+     * values and when the queue is drained, so a power loss can lose the latest queued values.
+     * Only values of up to MCC_QUEUE_VALUE_SIZE bytes are queued.
+     *
+     * @param capacity Maximum number of queued values
+     * @param overflow What to do with a value when the queue is full
+     * @param drain_rate Number of queued values sent per second
+     *
+     * @returns 0 if successful, non-0 if the queue file could not be opened
+     */
+    int enable_offline_queue(uint32_t capacity, mcc_queue_overflow overflow = MCC_QUEUE_DROP_OLDEST,
+                             uint32_t drain_rate = 10);
+
+    /**
+     * Set a callback that fires right before a queued value is sent, with the time it was written
+     *
+     * @param cb Callback with the resource (holding the queued value) and the time(NULL) of the write
+     */
+    void on_queued_value(Callback<void(MbedCloudClientResource*, uint32_t)> cb);
+
+    /**
+     * Limit the notifications in flight, and send them in order of priority class
+     *
+     * Each resource has at most one queued notification, which carries its latest value.
+     * When more than max_pending are queued, the oldest notification of the lowest class
+     * is dropped; the value is still stored, only the notification is not sent.
+     * High priority notifications are never dropped, and are queued again when sending fails.
+     * A notification that is not acknowledged within device-management.notification-in-flight-timeout-ms
+     * counts as failed.
+     *
+     * @param max_in_flight Notifications sent but not acknowledged at the same time,
+     *                      0 to send every notification at once
+     * @param max_pending Notifications waiting to be sent, 0 for no limit
+     */
+    void notification_limits(uint32_t max_in_flight, uint32_t max_pending);
+
+    /**
+     * Get the counters of a priority class
+     *
+     * @param priority Priority class
+     *
+     * @returns Queued, sent, delivered and dropped counts and the latency from queued to delivered
+     */
+    mcc_priority_stats get_notification_stats(mcc_priority priority);
+
+    /**
+     * Get the connection and transport counters
+     *
+     * When the 'diagnostics-object-id' config is set, these are also published on
+     * instance 0 of that object every 'diagnostics-period-ms', resources 0-8 in the
+     * order of the fields of mcc_diagnostics.
+     * Byte counts need "nsapi.socket-stats-enabled" and cover all sockets.
+     *
+     * @returns Snapshot of the counters
+     */
+    mcc_diagnostics get_diagnostics();
+
+    /**
+     * Get the number of values in the offline queue
+     */
+    uint32_t get_offline_queue_count();
+
+    /**
+     * Get the number of values dropped because the offline queue was full
+     */
+    uint32_t get_offline_queue_dropped();
+
     /**
     * Sends a registration update message to the Cloud when the client is registered
     * successfully to the Cloud and there is no internal connection error.
     * If the client is not connected and there is some other internal network
     * transaction ongoing, this function triggers an error MbedCloudClient::ConnectNotAllowed.
+    *
+    * Calls within the register update window (device-management.register-update-window-ms)
+    * are merged into one update. Calls while an update is in flight are merged into one
+    * update that is sent when the update in flight completes.
+    * The update is sent from the shared event queue.
     */
     void register_update();
 
+    /**
+     * Set the time register_update waits for more calls to merge
+     *
+     * @param window_ms Window in ms, 0 to send the update at once
+     */
+    void set_register_update_window(uint32_t window_ms);
+
+    /**
+     * Get the number of registration updates sent
+     */
+    uint32_t get_register_update_count();
+
+    /**
+     * Get the number of register_update calls that were merged into another update
+     */
+    uint32_t get_register_update_merged_count();
+
+    /**
+     * Set the time between two wake windows, for TCP_QUEUE_MODE and UDP_QUEUE_MODE
+     *
+     * While the client sleeps, notifications and registration updates are held and then
+     * sent together in one wake window. A window starts with a registration update, or
+     * when the client wakes by itself, and ends when the client goes back to sleep.
+     * High priority notifications open a window at once.
+     * The period is capped at 3/4 of the registration lifetime, so the update that opens
+     * a window also keeps the registration alive. In the other transport modes the client
+     * never sleeps, so everything is sent at once after the first window opens.
+     *
+     * @param period_ms Period in ms, 0 to send at once
+     */
+    void set_wake_window_period(uint32_t period_ms);
+
+    /**
+     * Get the counters of the wake windows
+     *
+     * @returns Number of windows, and the messages sent and time awake in total and in the last window
+     */
+    mcc_wake_window_stats get_wake_window_stats();
+
     /**
      * Checks registration status
      *
@@ -84,6 +422,51 @@ public:
      */
     bool is_client_registered();
 
+    /**
+     * Block the calling thread until the client is registered
+     *
+     * The thread sleeps until the state changes, instead of polling 'is_client_registered'.
+     * Must not be called from the Mbed Cloud Client thread or from the shared event queue
+     * when that dispatches the client callbacks.
+     *
+     * @param timeout_ms Maximum time to wait, osWaitForever to wait without limit
+     *
+     * @returns true when registered, false when the timeout expired
+     */
+    bool wait_for_registration(uint32_t timeout_ms = osWaitForever);
+
+    /**
+     * Block the calling thread until one of the given events occurred
+     *
+     * MCC_EVENT_UNREGISTERED and MCC_EVENT_ERROR are cleared when they are returned,
+     * MCC_EVENT_REGISTERED stays set for as long as the client is registered.
+     *
+     * @param events Mask of mcc_client_event values to wait for
+     * @param timeout_ms Maximum time to wait, osWaitForever to wait without limit
+     *
+     * @returns The events that occurred, 0 when the timeout expired
+     */
+    uint32_t wait_for_event(uint32_t events, uint32_t timeout_ms = osWaitForever);
+
+    /**
+     * Check for events without blocking or clearing them
+     *
+     * Together with 'wait_for_event' this can be used like a future: start
+     * registration, do other work, and check or wait for the result later.
+     *
+     * @param events Mask of mcc_client_event values to check
+     *
+     * @returns The events that occurred
+     */
+    uint32_t get_events(uint32_t events);
+
+    /**
+     * Get the error code of the last MCC_EVENT_ERROR
+     *
+     * @returns MbedCloudClient::Error code, 0 if no error occurred
+     */
+    int get_last_error();
+
     /**
      * Whether the device has ever tried registering
      *
@@ -130,10 +513,51 @@ public:
      *
      * @param path LwM2M path (in the form of 3200/0/5501)
      * @param name Name of the resource (will be shown in the UI)
+     * @param type Data type of the value (STRING, INTEGER, FLOAT, BOOLEAN, OPAQUE or TIME).
+     *             Typed values are stored natively and not serialized to strings.
      *
      * @returns new instance of MbedCloudClientResource
      */
-    MbedCloudClientResource* create_resource(const char *path, const char *name);
+    MbedCloudClientResource* create_resource(const char *path, const char *name,
+                                             M2MResourceInstance::ResourceType type = M2MResourceInstance::STRING);
+
+    /**
+     * Add a resource that is owned by the application, e.g. a statically
+     * allocated MbedCloudClientStaticResource.
+     *
+     * This does not allocate memory, and the resource is not deleted by SimpleMbedCloudClient.
+     * Resources need to be added before first registration.
+     *
+     * @param resource Resource to add, must outlive SimpleMbedCloudClient
+     */
+    void add_resource(MbedCloudClientResource *resource);
+
+    /**
+     * Start a batch of resource updates
+     *
+     * Values set on registered resources from the calling thread are staged instead
+     * of being sent, until `commit` is called. Call both from the same thread that
+     * sets the values, values set from other threads are published as usual.
+     */
+    void begin_batch();
+
+    /**
+     * Publish all values staged since `begin_batch`
+     *
+     * All values are stored first, then every observed object instance is
+     * notified once, whatever the number of its resources in the batch.
+     * Resources that are observed individually are still notified each.
+     *
+     * @returns Number of resources that were published
+     */
+    int commit();
+
+    /**
+     * Whether a batch was started on the calling thread and not committed yet
+     *
+     * @returns true if `begin_batch` was called without `commit` on this thread
+     */
+    bool is_batch_active();
 
     /**
      * Sets the on_registered callback
@@ -179,6 +603,13 @@ public:
      */
     void on_error_cb(Callback<void(int, const char*)> cb);
 
+    /**
+     * Get the file system managed by the storage layer
+     *
+     * @returns File system of the primary partition, NULL before 'init'
+     */
+    FileSystem *get_file_system();
+
     /**
      * Format the underlying storage
      *
@@ -186,6 +617,16 @@ public:
      */
     int reformat_storage();
 
+    /**
+     * Get the duration of the startup phases of init() and registration
+     *
+     * When the 'startup-timing-resource' config is set, these are also
+     * reported on that resource after registration.
+     *
+     * @returns Phase durations
+     */
+    mcc_startup_timing get_startup_timing();
+
 private:
 
     /**
@@ -203,6 +644,250 @@ private:
      */
     void error(int error_code);
 
+    /**
+     * Callback from Mbed Cloud Client, fires when a registration update completed
+     */
+    void client_registration_updated();
+
+    /**
+     * Handle a register_update call, runs on the shared event queue
+     */
+    void update_requested();
+
+    /**
+     * Send the queued registration update if it is due, runs on the shared event queue
+     */
+    void update_timer_expired();
+
+    /**
+     * Handle the end of the registration update in flight, runs on the shared event queue
+     */
+    void update_completed();
+
+    /**
+     * Send the registration update, or start the timer of the queued one
+     *
+     * @param issue Whether the debouncer decided to send the update now
+     */
+    void apply_update_decision(bool issue);
+
+    /**
+     * Probe all network interfaces, runs on the shared event queue
+     */
+    void probe_networks();
+
+    /**
+     * Count a connection error against the active network interface, runs on the shared event queue
+     */
+    void failover_error();
+
+    /**
+     * Switch network interfaces if the active one is not the first healthy one
+     */
+    void failover_check();
+
+    /**
+     * Register over the network interface picked by failover_check, runs on the shared event queue
+     */
+    void network_switched();
+
+    /**
+     * Switch networks when the closed client did not report that it unregistered
+     */
+    void failover_close_timeout();
+
+    /**
+     * Start the idle timer of the next keep-alive, runs on the shared event queue
+     */
+    void schedule_keepalive();
+
+    /**
+     * Send a keep-alive if the connection was idle, runs on the shared event queue
+     */
+    void keepalive_due();
+
+    /**
+     * Record a completed registration update, runs on the shared event queue
+     */
+    void keepalive_succeeded();
+
+    /**
+     * Record a connection error, runs on the shared event queue
+     */
+    void keepalive_failed();
+
+    /**
+     * Restore the keep-alive search of the current network from the file
+     */
+    void load_keepalive();
+
+    /**
+     * Store the keep-alive search of the current network in the file
+     */
+    void save_keepalive();
+
+    /**
+     * Number of messages exchanged, to tell whether the connection was idle
+     */
+    uint32_t keepalive_traffic();
+
+    /**
+     * Callback from Mbed Cloud Client, fires when the client goes to sleep in queue mode
+     */
+    void client_sleeping();
+
+    /**
+     * Open a wake window because the client woke up, runs on the shared event queue
+     */
+    void wake_window_opened();
+
+    /**
+     * End the wake window because the client went to sleep, runs on the shared event queue
+     */
+    void wake_window_closed();
+
+    /**
+     * Wake the client for the next window, runs on the shared event queue
+     */
+    void wake_window_due();
+
+    /**
+     * Start the timer of the next wake window while the client sleeps
+     */
+    void schedule_wake_window();
+
+    /**
+     * Schedule a reconnect attempt after a lost connection, runs on the shared event queue
+     */
+    void reconnect_needed();
+
+    /**
+     * Reset the reconnect scheduler after registering, runs on the shared event queue
+     */
+    void reconnect_succeeded();
+
+    /**
+     * Re-register, runs on the shared event queue
+     */
+    void reconnect_attempt();
+
+    /**
+     * (Re)start the timer of the reconnect attempt the scheduler decided on
+     */
+    void schedule_reconnect();
+
+    /**
+     * Callback from the network interface, fires when the link status changes
+     */
+    void network_status_changed(nsapi_event_t event, intptr_t status);
+
+    /**
+     * Handle a link status change, runs on the shared event queue
+     */
+    void link_status_changed(intptr_t status);
+
+    /**
+     * Open the offline queue file if needed, the caller holds _offline_queue_mutex
+     */
+    bool open_offline_queue();
+
+    /**
+     * Create the resources of the diagnostics object
+     */
+    void create_diagnostics_object();
+
+    /**
+     * Write the counters to the diagnostics object, runs on the shared event queue
+     */
+    void publish_diagnostics();
+
+    /**
+     * Send queued notifications while fewer than the limit are in flight, runs on the shared event queue
+     */
+    void send_notifications();
+
+    /**
+     * Schedule 'expire_notifications' for when the oldest notification in flight times out,
+     * runs on the shared event queue
+     */
+    void schedule_notification_expiry();
+
+    /**
+     * Fail the notifications in flight for longer than device-management.notification-in-flight-timeout-ms,
+     * so they free their place, runs on the shared event queue
+     */
+    void expire_notifications();
+
+    /**
+     * Send the oldest queued value, runs on the shared event queue
+     */
+    void drain_offline_queue();
+
+    /**
+     * Queue the value of a resource if the client is offline or the queue is draining,
+     * called by MbedCloudClientResource
+     *
+     * @returns true if the value was queued (or dropped by the queue), false if it should be published
+     */
+    bool queue_value(MbedCloudClientResource *resource);
+
+    /**
+     * Schedule a drain of the values posted with 'MbedCloudClientResource::post_value'.
+     * Safe to call from any context, including interrupts.
+     */
+    void value_posted();
+
+    /**
+     * Change the priority of the notifications of a resource, unless one is queued or in flight
+     *
+     * @returns true if the priority was changed
+     */
+    bool set_notification_priority(MbedCloudClientResource *resource, mcc_priority priority);
+
+    /**
+     * Queue the notification of a resource if notifications are limited, called by MbedCloudClientResource
+     *
+     * @returns true if the notification was queued (or dropped), false if it should be sent at once
+     */
+    bool schedule_notification(MbedCloudClientResource *resource);
+
+    /**
+     * Track the delivery of a notification, called by MbedCloudClientResource
+     */
+    void notification_status(MbedCloudClientResource *resource, NoticationDeliveryStatus status);
+
+    /**
+     * Apply the values posted from other contexts, runs on the shared event queue
+     */
+    void drain_posted_values();
+
+    /**
+     * Publish the resources staged with the given MbedCloudClientResource::STAGED_* tag,
+     * notifying each object instance once
+     *
+     * @returns Number of resources that were published
+     */
+    int publish_staged(uint8_t tag);
+
+    /**
+     * Reset the init state machine to its first step
+     *
+     * @param format If set to true, will always format the file system
+     */
+    void init_start(bool format);
+
+    /**
+     * Run the current init step and move to the next one
+     *
+     * @returns 0 if successful, non-0 with the error of 'init' if not successful
+     */
+    int init_step();
+
+    /**
+     * Run one init step on the event queue and schedule the next one
+     */
+    void init_async_step();
+
     /**
      * Re-mount and re-format the storage layer
      *
@@ -219,12 +904,39 @@ private:
      */
     int verify_cloud_configuration(bool format);
 
+    /**
+     * Hash the credentials and the firmware version, for the verified configuration cache
+     *
+     * @param digest Receives the SHA-256 digest
+     *
+     * @returns 0 if successful, non-0 if the credentials could not be read
+     */
+    int compute_config_digest(uint8_t *digest);
+
+    /**
+     * Append a resource to the list of resources
+     *
+     * @param resource Resource to append
+     * @param managed If set to true, the resource is deleted in the destructor
+     */
+    void append_resource(MbedCloudClientResource *resource, bool managed);
+
+    /**
+     * Write the startup timing to the startup timing resource, if there is one
+     */
+    void publish_startup_timing();
+
     M2MObjectList                                       _obj_list;
     MbedCloudClient                                     _cloud_client;
-    bool                                                _registered;
+    EventFlags                                          _event_flags;
+    int                                                 _last_error;
     bool                                                _register_called;
     bool                                                _register_and_connect_called;
-    Vector<MbedCloudClientResource*>                    _resources;
+    osThreadId_t                                        _batch_thread;
+    Mutex                                               _batch_mutex;
+    volatile uint32_t                                   _drain_scheduled;
+    MbedCloudClientResource*                            _resources;
+    MbedCloudClientResource*                            _resources_tail;
     Callback<void(const ConnectorClientEndpointInfo*)>  _registered_cb;
     Callback<void()>                                    _unregistered_cb;
     Callback<void(int, const char*)>                    _error_cb;
@@ -232,6 +944,55 @@ private:
     BlockDevice *                                       _bd;
     FileSystem *                                        _fs;
     StorageHelper                                       _storage;
+    mcc_startup_timing                                  _timing;
+    uint64_t                                            _init_start_ms;
+    uint64_t                                            _register_start_ms;
+    MbedCloudClientResource*                            _timing_resource;
+    ReconnectBackoff                                    _reconnect;
+    bool                                                _reconnect_enabled;
+    bool                                                _closing;
+    int                                                 _reconnect_event;
+    RegistrationUpdateDebouncer                         _update_debouncer;
+    int                                                 _update_event;
+    DnsCacheInterface                                   _dns;
+    bool                                                _dns_enabled;
+    NetworkInterface*                                   _networks[NETWORK_FAILOVER_MAX];
+    NetworkFailover                                     _failover;
+    bool                                                _failover_enabled;
+    int                                                 _failover_event;
+    volatile int                                        _failover_switch_to;
+    int                                                 _failover_close_event;
+    KeepAliveProbe                                      _keepalive;
+    bool                                                _keepalive_enabled;
+    int                                                 _keepalive_event;
+    uint32_t                                            _keepalive_network;
+    uint32_t                                            _keepalive_interval_ms;
+    uint32_t                                            _keepalive_probe_ms;
+    uint32_t                                            _keepalive_traffic;
+    WakeWindowScheduler                                 _wake;
+    int                                                 _wake_event;
+    NotificationQueue                                   _offline_queue;
+    Mutex                                               _offline_queue_mutex;
+    uint32_t                                            _offline_queue_capacity;
+    mcc_queue_overflow                                  _offline_queue_overflow;
+    uint32_t                                            _offline_drain_interval_ms;
+    int                                                 _offline_drain_event;
+    Callback<void(MbedCloudClientResource*, uint32_t)>  _queued_value_cb;
+    NotificationScheduler                               _notifications;
+    Mutex                                               _notification_mutex;
+    volatile uint32_t                                   _send_scheduled;
+    int                                                 _notification_expiry_event;
+    mcc_diagnostics                                     _diagnostics;
+    MbedCloudClientResource*                            _diagnostics_resources[9];
+    int                                                 _diagnostics_event;
+    bool                                                _init_running;
+    mcc_init_step                                       _init_step;
+    bool                                                _init_format;
+    bool                                                _init_storage_reset;
+    bool                                                _init_verify_retry;
+    EventQueue*                                         _init_queue;
+    Callback<void(int)>                                 _init_done_cb;
+    Callback<void(mcc_init_step)>                       _init_progress_cb;
 };
 
 #endif // SIMPLEMBEDCLOUDCLIENT_H
@@ -0,0 +1,80 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "wake-window-scheduler.h"
+
+#include <string.h>
+
+WakeWindowScheduler::WakeWindowScheduler()
+    : _period_ms(0),
+      _open(false),
+      _opened_ms(0),
+      _next_window_ms(0),
+      _messages(0)
+{
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+void WakeWindowScheduler::configure(uint32_t period_ms) {
+    _period_ms = period_ms;
+    _next_window_ms = _open ? _opened_ms + period_ms : 0;
+}
+
+bool WakeWindowScheduler::enabled() const {
+    return _period_ms > 0;
+}
+
+bool WakeWindowScheduler::is_open() const {
+    return _open;
+}
+
+void WakeWindowScheduler::on_wake(uint64_t now_ms) {
+    if (_open) return;
+
+    _open = true;
+    _opened_ms = now_ms;
+    _messages = 0;
+    _next_window_ms = now_ms + _period_ms;
+}
+
+void WakeWindowScheduler::on_sleep(uint64_t now_ms) {
+    if (!_open) return;
+
+    _open = false;
+
+    uint32_t awake = now_ms > _opened_ms ? (uint32_t)(now_ms - _opened_ms) : 0;
+    _stats.windows++;
+    _stats.messages += _messages;
+    _stats.awake_ms += awake;
+    _stats.last_messages = _messages;
+    _stats.last_awake_ms = awake;
+}
+
+void WakeWindowScheduler::on_message() {
+    if (_open) {
+        _messages++;
+    }
+}
+
+uint64_t WakeWindowScheduler::next_window_ms() const {
+    return _next_window_ms;
+}
+
+mcc_wake_window_stats WakeWindowScheduler::stats() const {
+    return _stats;
+}
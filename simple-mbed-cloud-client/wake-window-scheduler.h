@@ -0,0 +1,104 @@
+// ----------------------------------------------------------------------------
+// Copyright 2016-2018 ARM Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef WAKE_WINDOW_SCHEDULER_H
+#define WAKE_WINDOW_SCHEDULER_H
+
+#include <stdint.h>
+
+/**
+ * Counters of the wake windows
+ */
+struct mcc_wake_window_stats {
+    uint32_t windows;           // Wake windows that ended
+    uint32_t messages;          // Notifications and registration updates sent in all windows
+    uint64_t awake_ms;          // Time awake in all windows
+    uint32_t last_messages;     // Messages sent in the last window
+    uint32_t last_awake_ms;     // Time awake in the last window
+};
+
+/**
+ * Decides when a device in queue mode wakes up to send.
+ *
+ * Outbound messages are held while the device sleeps, and sent together in
+ * one wake window. A window starts one period after the previous one, or
+ * earlier when the device is woken for another reason, and ends when the
+ * device goes back to sleep.
+ *
+ * This class does not depend on Mbed OS, time is passed in by the caller.
+ */
+class WakeWindowScheduler {
+public:
+    WakeWindowScheduler();
+
+    /**
+     * Configure the period. 0 disables wake windows.
+     *
+     * @param period_ms Time from the start of one window to the start of the next
+     */
+    void configure(uint32_t period_ms);
+
+    /**
+     * Whether wake windows are enabled
+     */
+    bool enabled() const;
+
+    /**
+     * Whether the device is awake, so messages can be sent now
+     */
+    bool is_open() const;
+
+    /**
+     * Record that the device woke up, opens a window if none is open
+     *
+     * @param now_ms Current time
+     */
+    void on_wake(uint64_t now_ms);
+
+    /**
+     * Record that the device went to sleep, ends the open window
+     *
+     * @param now_ms Current time
+     */
+    void on_sleep(uint64_t now_ms);
+
+    /**
+     * Record a message sent in the open window
+     */
+    void on_message();
+
+    /**
+     * Time at which the next window should start
+     */
+    uint64_t next_window_ms() const;
+
+    /**
+     * Counters of the windows that ended
+     */
+    mcc_wake_window_stats stats() const;
+
+private:
+    uint32_t _period_ms;
+    bool _open;
+    uint64_t _opened_ms;
+    uint64_t _next_window_ms;
+    uint32_t _messages;
+    mcc_wake_window_stats _stats;
+};
+
+#endif // WAKE_WINDOW_SCHEDULER_H
@@ -17,6 +17,8 @@
 // ----------------------------------------------------------------------------
 
 #include "storage-helper/storage-helper.h"
+#include "key_config_manager.h"
+#include "pal_configuration.h"
 #include "mbed_trace.h"
 
 #define TRACE_GROUP "SMCS"
@@ -197,6 +199,66 @@ int StorageHelper::format(FileSystem *fs, BlockDevice *bd) {
     return status;
 }
 
+FileSystem *StorageHelper::get_file_system() {
+    return fs1;
+}
+
+int StorageHelper::read_file(const char *path, void *buffer, size_t size) {
+    if (!fs1) return -1;
+
+    File file;
+    int status = file.open(fs1, path, O_RDONLY);
+    if (status != 0) {
+        return status;
+    }
+
+    ssize_t length = file.read(buffer, size);
+    file.close();
+
+    return (int)length;
+}
+
+int StorageHelper::write_file(const char *path, const void *buffer, size_t size) {
+    if (!fs1) return -1;
+
+    File file;
+    int status = file.open(fs1, path, O_WRONLY | O_CREAT | O_TRUNC);
+    if (status != 0) {
+        tr_warn("Could not create %s (%d)", path, status);
+        return status;
+    }
+
+    ssize_t length = file.write(buffer, size);
+    status = file.close();
+    if (length != (ssize_t)size) {
+        tr_warn("Could not write %s (%d)", path, (int)length);
+        return length < 0 ? (int)length : -1;
+    }
+
+    return status;
+}
+
+int StorageHelper::remove_file(const char *path) {
+    if (!fs1) return -1;
+
+    return fs1->remove(path);
+}
+
+int StorageHelper::clear_ssl_session() {
+#if defined(PAL_USE_SSL_SESSION_RESUME) && PAL_USE_SSL_SESSION_RESUME && !defined(MCC_SSL_SESSION_ITEM_NAME)
+    tr_warn("Cannot remove the stored TLS session, device-management.ssl-session-item-name is not set");
+    return -1;
+#elif defined(PAL_USE_SSL_SESSION_RESUME) && PAL_USE_SSL_SESSION_RESUME
+    kcm_status_e status = kcm_item_delete((const uint8_t*)MCC_SSL_SESSION_ITEM_NAME, strlen(MCC_SSL_SESSION_ITEM_NAME),
+                                          KCM_CONFIG_ITEM);
+    if (status != KCM_STATUS_SUCCESS && status != KCM_STATUS_ITEM_NOT_FOUND) {
+        tr_warn("Could not remove the stored TLS session (%d)", status);
+        return status;
+    }
+#endif
+    return 0;
+}
+
 #if (MCC_PLATFORM_PARTITION_MODE == 1)
 // bd must be initialized before calling this function.
 int StorageHelper::init_and_mount_partition(FileSystem **fs, BlockDevice** part, int number_of_partition, const char* mount_point) {
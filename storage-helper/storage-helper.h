@@ -79,6 +79,12 @@
 
 #endif // MCC_PLATFORM_PARTITION_MODE
 
+// Secure storage item in which PAL keeps the TLS/DTLS session for resumption. It must match the name
+// used by the linked mbed-cloud-client, so there is no default.
+#if !defined(MCC_SSL_SESSION_ITEM_NAME) && defined(MBED_CONF_DEVICE_MANAGEMENT_SSL_SESSION_ITEM_NAME)
+#define MCC_SSL_SESSION_ITEM_NAME MBED_CONF_DEVICE_MANAGEMENT_SSL_SESSION_ITEM_NAME
+#endif
+
 // Include this only for Developer mode and device which doesn't have in-built TRNG support
 #if MBED_CONF_DEVICE_MANAGEMENT_DEVELOPER_MODE == 1
 #ifdef PAL_USER_DEFINED_CONFIGURATION
@@ -131,6 +137,55 @@ public:
      */
     static int format(FileSystem *fs, BlockDevice *bd);
 
+    /**
+     * Get the file system of the primary partition
+     *
+     * @returns File system, NULL before 'init' was called
+     */
+    FileSystem *get_file_system();
+
+    /**
+     * Read a file on the primary partition
+     *
+     * @param path Path of the file, relative to the file system
+     * @param buffer Buffer to read into
+     * @param size Size of the buffer
+     *
+     * @returns Number of bytes read if successful, negative when not successful
+     */
+    int read_file(const char *path, void *buffer, size_t size);
+
+    /**
+     * Create or replace a file on the primary partition
+     *
+     * @param path Path of the file, relative to the file system
+     * @param buffer Content of the file
+     * @param size Size of the content
+     *
+     * @returns 0 if successful, non-0 when not successful
+     */
+    int write_file(const char *path, const void *buffer, size_t size);
+
+    /**
+     * Remove a file from the primary partition
+     *
+     * @param path Path of the file, relative to the file system
+     *
+     * @returns 0 if successful, non-0 when not successful
+     */
+    int remove_file(const char *path);
+
+    /**
+     * Remove the TLS/DTLS session stored for resumption, so the next
+     * connection does a full handshake. The session is kept in secure
+     * storage next to the SOTP data when PAL_USE_SSL_SESSION_RESUME is set,
+     * under the item name set with MCC_SSL_SESSION_ITEM_NAME.
+     *
+     * @returns 0 if successful or there was no session, non-0 when not successful
+     *          or when the item name is not set
+     */
+    int clear_ssl_session();
+
 private:
 #if (MCC_PLATFORM_PARTITION_MODE == 1)
     // for checking that PRIMARY_PARTITION_SIZE and SECONDARY_PARTITION_SIZE do not overflow.